@@ -0,0 +1,373 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// Measures the throughput and the number of allocations of encoding and decoding with the
+// converters, both through the DOM and without it, compared to hand-written code using the DOM
+// of nlohmann/json directly.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/containers.hpp"
+#include "thesauros/format.hpp"
+#include "thesauros/macropolis.hpp"
+
+#include "jaybird/jaybird.hpp"
+
+namespace {
+std::atomic<std::size_t> allocation_num{0};
+} // namespace
+
+// Counts the allocations, which are not inlined so that the compiler does not see the matching
+// `malloc` and `free` calls.
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  allocation_num.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+[[gnu::noinline]] void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+[[gnu::noinline]] void operator delete(void* ptr, std::size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+THES_DEFINE_ENUM(SNAKE_CASE(Color), std::uint8_t, LOWERCASE(RED), LOWERCASE(GREEN), LOWERCASE(BLUE),
+                 LOWERCASE(CYAN), LOWERCASE(MAGENTA), LOWERCASE(YELLOW));
+
+struct Wide {
+  THES_DEFINE_TYPE(SNAKE_CASE(Wide), CONSTEXPR_CONSTRUCTOR,
+                   MEMBERS((KEEP(id), std::int64_t), (KEEP(name), std::string), (KEEP(x), double),
+                           (KEEP(y), double), (KEEP(z), double), (KEEP(active), bool),
+                           (KEEP(count), std::uint32_t), (KEEP(label), std::string),
+                           (KEEP(weight), float), (KEEP(tags), std::vector<std::string>),
+                           (KEEP(score), double), (KEEP(level), int), (KEEP(color), Color),
+                           (KEEP(note), std::optional<std::string>), (KEEP(ratio), double),
+                           (KEEP(parent), std::int64_t)))
+};
+struct Point {
+  THES_DEFINE_TYPE(SNAKE_CASE(Point), CONSTEXPR_CONSTRUCTOR,
+                   MEMBERS((KEEP(x), float), (KEEP(y), (std::pair<float, int>)), (KEEP(z), int)))
+};
+struct Segment {
+  THES_DEFINE_TYPE(SNAKE_CASE(Segment), CONSTEXPR_CONSTRUCTOR,
+                   MEMBERS((KEEP(weight), float), (KEEP(from), Point), (KEEP(to), Point),
+                           (KEEP(id), int)))
+};
+
+// Alternatives with distinct names for `std::variant` and with a discriminating static member
+// for `UniVariant`.
+#define JAYBIRD_BENCH_ALTERNATIVE(NAME) \
+  struct NAME { \
+    THES_DEFINE_TYPE(SNAKE_CASE(NAME), CONSTEXPR_CONSTRUCTOR, \
+                     MEMBERS((KEEP(value), double), (KEEP(id), int))) \
+  };
+JAYBIRD_BENCH_ALTERNATIVE(Alpha)
+JAYBIRD_BENCH_ALTERNATIVE(Beta)
+JAYBIRD_BENCH_ALTERNATIVE(Gamma)
+JAYBIRD_BENCH_ALTERNATIVE(Delta)
+JAYBIRD_BENCH_ALTERNATIVE(Epsilon)
+JAYBIRD_BENCH_ALTERNATIVE(Zeta)
+JAYBIRD_BENCH_ALTERNATIVE(Eta)
+JAYBIRD_BENCH_ALTERNATIVE(Theta)
+#undef JAYBIRD_BENCH_ALTERNATIVE
+using Variant = std::variant<Alpha, Beta, Gamma, Delta, Epsilon, Zeta, Eta, Theta>;
+
+template<int tKind>
+struct Event {
+  THES_DEFINE_TYPE(SNAKE_CASE(Event), CONSTEXPR_CONSTRUCTOR, STATIC_MEMBERS((KEEP(kind), tKind)),
+                   MEMBERS((KEEP(value), double), (KEEP(id), int)))
+};
+using UniEvent = jay::UniVariant<Event<0>, Event<1>, Event<2>, Event<3>, Event<4>, Event<5>,
+                                 Event<6>, Event<7>>;
+
+using Json = jay::Json;
+
+// Hand-written conversions using the DOM of nlohmann/json.
+namespace manual {
+inline std::string_view color_name(Color color) {
+  static constexpr std::array<std::string_view, 6> names{"red",  "green",   "blue",
+                                                         "cyan", "magenta", "yellow"};
+  return names[static_cast<std::size_t>(color)];
+}
+inline Color color_from(const Json& json) {
+  const auto& name = json.get_ref<const std::string&>();
+  for (std::uint8_t i = 0; i < 6; ++i) {
+    if (color_name(static_cast<Color>(i)) == name) {
+      return static_cast<Color>(i);
+    }
+  }
+  throw std::invalid_argument{"unknown color"};
+}
+
+inline Json to_dom(const Wide& value) {
+  Json json{
+    {"id", value.id},         {"name", value.name},     {"x", value.x},
+    {"y", value.y},           {"z", value.z},           {"active", value.active},
+    {"count", value.count},   {"label", value.label},   {"weight", value.weight},
+    {"score", value.score},   {"level", value.level},
+    {"ratio", value.ratio},   {"parent", value.parent},
+  };
+  auto& tags = json["tags"] = Json::array();
+  for (const std::string& tag : value.tags) {
+    tags.push_back(tag);
+  }
+  json["color"] = color_name(value.color);
+  json["note"] = value.note.has_value() ? Json(*value.note) : Json{};
+  return json;
+}
+inline Wide from_dom(const Json& json, std::type_identity<Wide> /*tag*/) {
+  std::vector<std::string> tags{};
+  for (const Json& tag : json.at("tags")) {
+    tags.push_back(tag.get<std::string>());
+  }
+  const Json& note = json.at("note");
+  return Wide{json.at("id").get<std::int64_t>(),
+              json.at("name").get<std::string>(),
+              json.at("x").get<double>(),
+              json.at("y").get<double>(),
+              json.at("z").get<double>(),
+              json.at("active").get<bool>(),
+              json.at("count").get<std::uint32_t>(),
+              json.at("label").get<std::string>(),
+              json.at("weight").get<float>(),
+              std::move(tags),
+              json.at("score").get<double>(),
+              json.at("level").get<int>(),
+              color_from(json.at("color")),
+              note.is_null() ? std::nullopt : std::optional{note.get<std::string>()},
+              json.at("ratio").get<double>(),
+              json.at("parent").get<std::int64_t>()};
+}
+
+inline Json to_dom(const Point& value) {
+  return Json{{"x", value.x}, {"y", Json::array({value.y.first, value.y.second})}, {"z", value.z}};
+}
+inline Point from_dom(const Json& json, std::type_identity<Point> /*tag*/) {
+  const Json& y = json.at("y");
+  return Point{json.at("x").get<float>(), {y.at(0).get<float>(), y.at(1).get<int>()},
+               json.at("z").get<int>()};
+}
+inline Json to_dom(const Segment& value) {
+  return Json{{"weight", value.weight},
+              {"from", to_dom(value.from)},
+              {"to", to_dom(value.to)},
+              {"id", value.id}};
+}
+inline Segment from_dom(const Json& json, std::type_identity<Segment> /*tag*/) {
+  return Segment{json.at("weight").get<float>(),
+                 from_dom(json.at("from"), std::type_identity<Point>{}),
+                 from_dom(json.at("to"), std::type_identity<Point>{}), json.at("id").get<int>()};
+}
+
+inline Json to_dom(Color value) {
+  return color_name(value);
+}
+inline Color from_dom(const Json& json, std::type_identity<Color> /*tag*/) {
+  return color_from(json);
+}
+
+inline Json to_dom(const std::vector<double>& value) {
+  auto json = Json::array();
+  for (const double v : value) {
+    json.push_back(v);
+  }
+  return json;
+}
+inline std::vector<double> from_dom(const Json& json,
+                                    std::type_identity<std::vector<double>> /*tag*/) {
+  std::vector<double> out{};
+  out.reserve(json.size());
+  for (const Json& v : json) {
+    out.push_back(v.get<double>());
+  }
+  return out;
+}
+
+template<typename T>
+inline Json to_dom(const std::vector<T>& records) {
+  auto json = Json::array();
+  for (const T& record : records) {
+    json.push_back(to_dom(record));
+  }
+  return json;
+}
+template<typename T>
+inline std::vector<T> from_dom(const Json& json, std::type_identity<std::vector<T>> /*tag*/) {
+  std::vector<T> out{};
+  out.reserve(json.size());
+  for (const Json& record : json) {
+    out.push_back(from_dom(record, std::type_identity<T>{}));
+  }
+  return out;
+}
+} // namespace manual
+
+template<typename T>
+concept HasManual = requires(const T& value, const Json& json) {
+  manual::to_dom(value);
+  manual::from_dom(json, std::type_identity<T>{});
+};
+
+struct Result {
+  double seconds;
+  std::size_t allocations;
+};
+
+// The fastest of a few runs together with the allocations of a single run.
+template<typename TOp>
+Result measure(TOp op) {
+  double best = 1e300;
+  std::size_t allocations = 0;
+  for (int i = 0; i < 3; ++i) {
+    const std::size_t allocations_before = allocation_num.load(std::memory_order_relaxed);
+    const auto begin = std::chrono::steady_clock::now();
+    op();
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - begin;
+    best = std::min(best, time.count());
+    allocations = allocation_num.load(std::memory_order_relaxed) - allocations_before;
+  }
+  return {best, allocations};
+}
+
+void report(std::string_view name, std::size_t bytes, std::size_t record_num, Result result) {
+  fmt::print("  {:<32} {:9.1f} MB/s {:12.0f} records/s {:12} allocations\n", name,
+             static_cast<double>(bytes) / 1e6 / result.seconds,
+             static_cast<double>(record_num) / result.seconds, result.allocations);
+}
+
+// Encodes and decodes a vector of records in all supported ways.
+template<typename T>
+void bench(std::string_view name, const std::vector<T>& records) {
+  using Vec = std::vector<T>;
+  const std::string text = jay::to_json_string(records);
+  if (jay::parse<Vec>(text).size() != records.size()) {
+    throw std::logic_error{"The decoded records differ!"};
+  }
+  fmt::print("{}: {} records, {:.2f} MB\n", name, records.size(),
+             static_cast<double>(text.size()) / 1e6);
+
+  auto run = [&](std::string_view label, auto op) {
+    report(label, text.size(), records.size(), measure([&] { static_cast<void>(op()); }));
+  };
+  run("encode to_json_string", [&] { return jay::to_json_string(records); });
+  run("encode to_json + dump", [&] { return jay::to_json(records).dump(); });
+  if constexpr (HasManual<T>) {
+    run("encode manual + dump", [&] { return manual::to_dom(records).dump(); });
+  }
+  run("decode parse", [&] { return jay::parse<Vec>(text); });
+  run("decode Json::parse + from_json", [&] { return jay::from_json<Vec>(Json::parse(text)); });
+  if constexpr (HasManual<T>) {
+    run("decode Json::parse + manual",
+        [&] { return manual::from_dom(Json::parse(text), std::type_identity<Vec>{}); });
+  }
+}
+
+int main(int argc, char** argv) {
+  const std::size_t scale = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+  const std::size_t record_num = 20000 * scale;
+
+  std::vector<Wide> wides{};
+  std::vector<Segment> segments{};
+  std::vector<Variant> variants{};
+  std::vector<UniEvent> events{};
+  std::vector<Color> colors{};
+  std::vector<thes::LimitedArray<double, 64>> limited{};
+  for (std::size_t i = 0; i < record_num; ++i) {
+    const auto x = static_cast<double>(i);
+    const auto n = static_cast<int>(i);
+    const auto color = static_cast<Color>(i % 6);
+    std::optional<std::string> note{};
+    if (i % 3 == 0) {
+      note = fmt::format("note for record {}", i);
+    }
+    wides.push_back(Wide{static_cast<std::int64_t>(i), fmt::format("record-{}", i), x * 0.5,
+                         -x, x / 7.0, i % 2 == 0, static_cast<std::uint32_t>(i % 1000),
+                         "/data/records/" + std::to_string(i % 97),
+                         static_cast<float>(i % 100) * 0.25F,
+                         std::vector<std::string>(i % 4, "tag"), x * 1e-3, n % 10, color,
+                         std::move(note), 1.0 / (x + 1.0), static_cast<std::int64_t>(i / 2)});
+    segments.push_back(Segment{0.5F, Point{1.5F, {2.0F, n}, 3}, Point{-1.0F, {0.25F, -n}, n}, n});
+    switch (i % 8) {
+      case 0: variants.emplace_back(Alpha{x, n}); break;
+      case 1: variants.emplace_back(Beta{x, n}); break;
+      case 2: variants.emplace_back(Gamma{x, n}); break;
+      case 3: variants.emplace_back(Delta{x, n}); break;
+      case 4: variants.emplace_back(Epsilon{x, n}); break;
+      case 5: variants.emplace_back(Zeta{x, n}); break;
+      case 6: variants.emplace_back(Eta{x, n}); break;
+      default: variants.emplace_back(Theta{x, n}); break;
+    }
+    switch (i % 8) {
+      case 0: events.emplace_back(Event<0>{x, n}); break;
+      case 1: events.emplace_back(Event<1>{x, n}); break;
+      case 2: events.emplace_back(Event<2>{x, n}); break;
+      case 3: events.emplace_back(Event<3>{x, n}); break;
+      case 4: events.emplace_back(Event<4>{x, n}); break;
+      case 5: events.emplace_back(Event<5>{x, n}); break;
+      case 6: events.emplace_back(Event<6>{x, n}); break;
+      default: events.emplace_back(Event<7>{x, n}); break;
+    }
+    colors.push_back(color);
+    if (i % 16 == 0) {
+      auto& arr = limited.emplace_back();
+      for (std::size_t j = 0; j < 64; ++j) {
+        arr.push_back(x + static_cast<double>(j) / 64.0);
+      }
+    }
+  }
+  std::vector<std::vector<double>> numbers(4);
+  for (std::size_t i = 0; i < numbers.size(); ++i) {
+    numbers[i].resize(record_num * 16);
+    for (std::size_t j = 0; j < numbers[i].size(); ++j) {
+      numbers[i][j] = static_cast<double>(i * j) / 3.0;
+    }
+  }
+
+  bench("wide structs", wides);
+  bench("nested structs", segments);
+  bench("std::variant with 8 alternatives", variants);
+  bench("UniVariant with 8 alternatives", events);
+  bench("enums", colors);
+  bench("LimitedArray<double, 64>", limited);
+  bench("large numeric arrays", numbers);
+
+  // Reading a multi-MB file
+  const auto path = std::filesystem::temp_directory_path() / "jaybird-bench-converters.json";
+  jay::write_file(path, wides);
+  const std::size_t bytes = std::filesystem::file_size(path);
+  fmt::print("read_file: {} records, {:.2f} MB\n", wides.size(), static_cast<double>(bytes) / 1e6);
+  auto run = [&](std::string_view label, auto op) {
+    report(label, bytes, wides.size(), measure([&] { static_cast<void>(op()); }));
+  };
+  run("read_file<T>", [&] { return jay::read_file<std::vector<Wide>>(path); });
+  run("read_file + from_json",
+      [&] { return jay::from_json<std::vector<Wide>>(jay::read_file(path)); });
+  run("ifstream + Json::parse + manual", [&] {
+    std::ifstream in{path, std::ios::binary};
+    return manual::from_dom(Json::parse(in), std::type_identity<std::vector<Wide>>{});
+  });
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,83 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// Measures the scaling of `read_records` with the number of threads for JSON Lines
+// and top-level arrays, compared to the sequential `read_file`.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thesauros/format.hpp"
+
+#include "jaybird/jaybird.hpp"
+
+using Record = std::map<std::string, std::vector<double>>;
+
+template<typename TOp>
+double measure(TOp op) {
+  double best = 1e300;
+  for (int i = 0; i < 3; ++i) {
+    const auto begin = std::chrono::steady_clock::now();
+    op();
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - begin;
+    best = std::min(best, time.count());
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  const std::size_t record_num = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+  std::vector<Record> records(record_num);
+  for (std::size_t i = 0; i < record_num; ++i) {
+    const auto x = static_cast<double>(i);
+    records[i] = Record{{"id", {x}}, {"position", {x * 0.5, x * 0.25, -x}}, {"weights", {}}};
+    records[i]["weights"].assign(i % 16, x / 3.0);
+  }
+
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto array_path = dir / "jaybird-bench-records.json";
+  const auto lines_path = dir / "jaybird-bench-records.jsonl";
+  jay::write_file(array_path, records);
+  {
+    jay::JsonLinesWriter<Record> writer{lines_path};
+    for (const Record& record : records) {
+      writer.write(record);
+    }
+  }
+  const auto mib = static_cast<double>(std::filesystem::file_size(array_path)) / 1048576.0;
+
+  const double sequential =
+    measure([&] { static_cast<void>(jay::read_file<std::vector<Record>>(array_path)); });
+  fmt::print("{} records, {:.1f} MiB\n", record_num, mib);
+  fmt::print("read_file: {:.3f} s, {:.1f} MiB/s\n", sequential, mib / sequential);
+
+  const std::size_t max_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  for (const auto& [name, path] : {std::pair{"array", array_path}, {"lines", lines_path}}) {
+    double single = 0;
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+      const double time = measure([&] {
+        static_cast<void>(jay::read_records<Record>(path, {.thread_num = threads}));
+      });
+      if (threads == 1) {
+        single = time;
+      }
+      fmt::print("{} with {} threads: {:.3f} s, {:.1f} MiB/s, {:.0f} records/s, speedup {:.2f}\n",
+                 name, threads, time, mib / time, static_cast<double>(record_num) / time,
+                 single / time);
+    }
+  }
+
+  std::filesystem::remove(array_path);
+  std::filesystem::remove(lines_path);
+}
@@ -0,0 +1,65 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// Measures the scaling of `write_range` with the number of threads compared to `write_json`.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thesauros/format.hpp"
+
+#include "jaybird/jaybird.hpp"
+
+using Record = std::map<std::string, std::vector<double>>;
+
+template<typename TOp>
+double measure(TOp op) {
+  double best = 1e300;
+  for (int i = 0; i < 3; ++i) {
+    const auto begin = std::chrono::steady_clock::now();
+    op();
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - begin;
+    best = std::min(best, time.count());
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  const std::size_t record_num = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+  std::vector<Record> records(record_num);
+  for (std::size_t i = 0; i < record_num; ++i) {
+    const auto x = static_cast<double>(i);
+    records[i] = Record{{"id", {x}}, {"position", {x * 0.5, x * 0.25, -x}}, {"weights", {}}};
+    records[i]["weights"].assign(i % 16, x / 3.0);
+  }
+
+  std::string out{};
+  const double sequential = measure([&] {
+    out.clear();
+    jay::write_json(out, records);
+  });
+  const auto mib = static_cast<double>(out.size()) / 1048576.0;
+  fmt::print("{} records, {:.1f} MiB\n", record_num, mib);
+  fmt::print("write_json: {:.3f} s, {:.1f} MiB/s\n", sequential, mib / sequential);
+
+  const std::size_t max_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    const double time = measure([&] {
+      out.clear();
+      jay::ContainerSink sink{out};
+      jay::write_range(records, sink, {.thread_num = threads});
+    });
+    fmt::print("write_range with {} threads: {:.3f} s, {:.1f} MiB/s, speedup {:.2f}\n", threads,
+               time, mib / time, sequential / time);
+  }
+}
@@ -2,7 +2,14 @@
 #define INCLUDE_JAYBIRD_BASE_HPP
 
 // IWYU pragma: begin_exports
+#include "base/arena.hpp"
+#include "base/decision-tree.hpp"
 #include "base/defs.hpp"
+#include "base/instrumentation.hpp"
+#include "base/intern.hpp"
+#include "base/parallel.hpp"
+#include "base/perfect-hash.hpp"
+#include "base/task.hpp"
 #include "base/type-info.hpp"
 #include "base/uni-variant.hpp"
 // IWYU pragma: end_exports
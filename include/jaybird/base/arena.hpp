@@ -0,0 +1,134 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_BASE_ARENA_HPP
+#define INCLUDE_JAYBIRD_BASE_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "jaybird/base/defs.hpp"
+
+namespace jay {
+// The memory resource used by `ArenaAllocator`s created on this thread.
+inline std::pmr::memory_resource*& current_arena() {
+  thread_local std::pmr::memory_resource* resource = std::pmr::new_delete_resource();
+  return resource;
+}
+
+// Makes a memory resource the current arena of this thread until the end of the scope.
+struct ArenaScope {
+  explicit ArenaScope(std::pmr::memory_resource& resource)
+      : previous_{std::exchange(current_arena(), &resource)} {}
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope(ArenaScope&&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+  ArenaScope& operator=(ArenaScope&&) = delete;
+  ~ArenaScope() {
+    current_arena() = previous_;
+  }
+
+private:
+  std::pmr::memory_resource* previous_;
+};
+
+// Allocates from the current arena at the time of construction.
+// `nlohmann::basic_json` default-constructs a new allocator whenever it allocates or frees
+// a value, so each allocation is preceded by a header storing its resource (i.e. 8 or 16 bytes),
+// which allows any allocator to free it, even after the scope of the arena has ended.
+template<typename T>
+struct ArenaAllocator {
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  ArenaAllocator() noexcept : resource_{current_arena()} {}
+  template<typename TOther>
+  ArenaAllocator(const ArenaAllocator<TOther>& other) noexcept // NOLINT
+      : resource_{other.resource()} {}
+
+  T* allocate(std::size_t size) {
+    if (size > (std::numeric_limits<std::size_t>::max() - header_size) / sizeof(T)) {
+      throw std::bad_array_new_length{};
+    }
+    auto* base = static_cast<std::byte*>(resource_->allocate(bytes(size), alignment));
+    ::new (base) std::pmr::memory_resource*(resource_);
+    return reinterpret_cast<T*>(base + header_size);
+  }
+  void deallocate(T* ptr, std::size_t size) noexcept {
+    std::byte* base = reinterpret_cast<std::byte*>(ptr) - header_size;
+    std::pmr::memory_resource* resource = *std::launder(
+      reinterpret_cast<std::pmr::memory_resource**>(base));
+    resource->deallocate(base, bytes(size), alignment);
+  }
+
+  [[nodiscard]] std::pmr::memory_resource* resource() const noexcept {
+    return resource_;
+  }
+
+  template<typename TOther>
+  bool operator==(const ArenaAllocator<TOther>& /*other*/) const noexcept {
+    return true;
+  }
+
+private:
+  static constexpr std::size_t alignment =
+    std::max(alignof(T), alignof(std::pmr::memory_resource*));
+  static constexpr std::size_t header_size = std::max(sizeof(void*), alignment);
+
+  static constexpr std::size_t bytes(std::size_t size) {
+    return header_size + size * sizeof(T);
+  }
+
+  std::pmr::memory_resource* resource_;
+};
+
+// A string which is allocated from the current arena.
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+// A DOM whose values, strings, arrays, and objects are allocated from the current arena.
+using ArenaJson = nlohmann::basic_json<std::map, std::vector, ArenaString, bool, Int, UInt, Real,
+                                       ArenaAllocator>;
+
+// A monotonic arena which is the current arena of this thread during its lifetime, e.g. for
+// a document which is parsed, processed, and discarded while handling a request.
+// Freeing values is a no-op and all memory is released at once when the arena is destroyed,
+// so no `ArenaJson` created in its scope may outlive it.
+// Destroying an `ArenaJson` still visits each of its values, which is avoided by moving it
+// into the arena using `keep`.
+struct Arena {
+  explicit Arena(std::size_t initial_size = 65536)
+      : resource_{initial_size}, scope_{resource_} {}
+
+  [[nodiscard]] std::pmr::memory_resource& resource() {
+    return resource_;
+  }
+
+  // Moves a DOM into the arena, where it is never destroyed, so that it is released together
+  // with the arena without visiting its values,
+  // e.g. `const ArenaJson& doc = arena.keep(ArenaJson::parse(text))`.
+  // All values of the DOM must have been allocated from this arena.
+  ArenaJson& keep(ArenaJson&& json) {
+    void* storage = resource_.allocate(sizeof(ArenaJson), alignof(ArenaJson));
+    return *::new (storage) ArenaJson(std::move(json));
+  }
+
+private:
+  std::pmr::monotonic_buffer_resource resource_;
+  ArenaScope scope_;
+};
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_BASE_ARENA_HPP
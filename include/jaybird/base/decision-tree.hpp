@@ -0,0 +1,204 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_BASE_DECISION_TREE_HPP
+#define INCLUDE_JAYBIRD_BASE_DECISION_TREE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace jay {
+// A requirement of an alternative: The value of the key with index `key` has to be in the
+// equivalence class `value`, where two requirements on the same key with the same class
+// are fulfilled by the same values.
+struct Discriminant {
+  std::size_t alternative;
+  std::size_t key;
+  std::size_t value;
+};
+
+// An internal node tests the value of `key` against the branches `begin` to `end`, continuing
+// at `next` if the key is missing or no branch matches.
+// A leaf selects the alternative `next` (or none if it is equal to the number of alternatives)
+// once the discriminants `checks[begin]` to `checks[end - 1]`, which have not been tested on the
+// way to the leaf, are fulfilled.
+struct DecisionNode {
+  static constexpr std::size_t leaf = std::numeric_limits<std::size_t>::max();
+
+  std::size_t key;
+  std::size_t begin;
+  std::size_t end;
+  std::size_t next;
+};
+struct DecisionBranch {
+  std::size_t discriminant;
+  std::size_t node;
+};
+
+// A decision tree which selects the only alternative whose discriminants are fulfilled,
+// where each key is tested at most once. The root is the first node.
+template<std::size_t tNodeNum, std::size_t tBranchNum, std::size_t tCheckNum>
+struct DecisionTree {
+  std::array<DecisionNode, tNodeNum> nodes{};
+  std::array<DecisionBranch, tBranchNum> branches{};
+  std::array<std::size_t, tCheckNum> checks{};
+};
+
+// Returns two alternatives which cannot be told apart because they do not have a key
+// with different values in common, i.e. some values fulfill the discriminants of both.
+constexpr std::optional<std::pair<std::size_t, std::size_t>>
+find_ambiguity(std::size_t alternative_num, std::span<const Discriminant> discriminants) {
+  for (std::size_t a = 0; a < alternative_num; ++a) {
+    for (std::size_t b = a + 1; b < alternative_num; ++b) {
+      const bool distinct = std::any_of(
+        discriminants.begin(), discriminants.end(), [&](const Discriminant& da) {
+          return da.alternative == a &&
+                 std::any_of(discriminants.begin(), discriminants.end(),
+                             [&](const Discriminant& db) {
+                               return db.alternative == b && db.key == da.key &&
+                                      db.value != da.value;
+                             });
+        });
+      if (!distinct) {
+        return std::pair{a, b};
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+namespace detail {
+struct DecisionTreeBuilder {
+  std::size_t alternative_num;
+  std::size_t key_num;
+  std::span<const Discriminant> discriminants;
+  std::vector<DecisionNode> nodes{};
+  std::vector<DecisionBranch> branches{};
+  std::vector<std::size_t> checks{};
+
+  // Builds the subtree for the alternatives in `candidates`, where the keys in `tested`
+  // have already been tested, and returns its index.
+  constexpr std::size_t build(const std::vector<bool>& candidates,
+                              const std::vector<bool>& tested) {
+    // Without a discriminating key, i.e. for at most one candidate or ambiguous candidates,
+    // the first candidate is selected
+    const std::size_t key = best_key(candidates);
+    if (key == key_num) {
+      const auto alternative = static_cast<std::size_t>(
+        std::find(candidates.begin(), candidates.end(), true) - candidates.begin());
+      const std::size_t begin = checks.size();
+      for (std::size_t i = 0; i < discriminants.size(); ++i) {
+        if (discriminants[i].alternative == alternative && !tested[discriminants[i].key]) {
+          checks.push_back(i);
+        }
+      }
+      nodes.push_back({DecisionNode::leaf, begin, checks.size(), alternative});
+      return nodes.size() - 1;
+    }
+
+    const std::size_t idx = nodes.size();
+    nodes.emplace_back();
+
+    // The candidates without the key are not constrained by it and are part of every branch
+    std::vector<bool> without = candidates;
+    std::vector<std::size_t> representatives{};
+    for (std::size_t i = 0; i < discriminants.size(); ++i) {
+      const Discriminant& d = discriminants[i];
+      if (d.key != key || !candidates[d.alternative]) {
+        continue;
+      }
+      without[d.alternative] = false;
+      const bool is_new = std::none_of(
+        representatives.begin(), representatives.end(),
+        [&](std::size_t r) { return discriminants[r].value == d.value; });
+      if (is_new) {
+        representatives.push_back(i);
+      }
+    }
+
+    std::vector<bool> child_tested = tested;
+    child_tested[key] = true;
+    std::vector<DecisionBranch> own{};
+    for (const std::size_t r : representatives) {
+      std::vector<bool> child = without;
+      for (const Discriminant& d : discriminants) {
+        if (d.key == key && d.value == discriminants[r].value && candidates[d.alternative]) {
+          child[d.alternative] = true;
+        }
+      }
+      own.push_back({r, build(child, child_tested)});
+    }
+    const std::size_t next = build(without, child_tested);
+
+    const std::size_t begin = branches.size();
+    branches.insert(branches.end(), own.begin(), own.end());
+    nodes[idx] = {key, begin, branches.size(), next};
+    return idx;
+  }
+
+  // The key with the most distinct values among the candidates, where ties are broken
+  // by the number of candidates with the key, or `key_num` if no key has distinct values.
+  [[nodiscard]] constexpr std::size_t best_key(const std::vector<bool>& candidates) const {
+    std::size_t best = key_num;
+    std::pair<std::size_t, std::size_t> best_score{0, 0};
+    for (std::size_t key = 0; key < key_num; ++key) {
+      std::vector<std::size_t> values{};
+      std::size_t with_key = 0;
+      for (const Discriminant& d : discriminants) {
+        if (d.key != key || !candidates[d.alternative]) {
+          continue;
+        }
+        ++with_key;
+        if (std::find(values.begin(), values.end(), d.value) == values.end()) {
+          values.push_back(d.value);
+        }
+      }
+      if (const std::pair score{values.size(), with_key}; score.first > 1 && score > best_score) {
+        best = key;
+        best_score = score;
+      }
+    }
+    return best;
+  }
+};
+
+template<auto tArgs>
+constexpr auto build_decision_tree() {
+  const auto [alternative_num, key_num, discriminants] = tArgs();
+  DecisionTreeBuilder builder{alternative_num, key_num, discriminants};
+  builder.build(std::vector<bool>(alternative_num, true), std::vector<bool>(key_num, false));
+  return std::tuple{std::move(builder.nodes), std::move(builder.branches),
+                    std::move(builder.checks)};
+}
+} // namespace detail
+
+// Builds a decision tree for alternatives which are pairwise distinguishable (see
+// `find_ambiguity`), where `tArgs` is a callable returning the number of alternatives,
+// the number of keys, and the discriminants.
+template<auto tArgs>
+constexpr auto make_decision_tree() {
+  constexpr auto sizes = [] {
+    const auto [nodes, branches, checks] = detail::build_decision_tree<tArgs>();
+    return std::array{nodes.size(), branches.size(), checks.size()};
+  }();
+
+  DecisionTree<sizes[0], sizes[1], sizes[2]> out{};
+  const auto [nodes, branches, checks] = detail::build_decision_tree<tArgs>();
+  std::copy(nodes.begin(), nodes.end(), out.nodes.begin());
+  std::copy(branches.begin(), branches.end(), out.branches.begin());
+  std::copy(checks.begin(), checks.end(), out.checks.begin());
+  return out;
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_BASE_DECISION_TREE_HPP
@@ -7,6 +7,8 @@
 #ifndef INCLUDE_JAYBIRD_BASE_DEFS_HPP
 #define INCLUDE_JAYBIRD_BASE_DEFS_HPP
 
+#include <cstddef>
+
 #include "nlohmann/json.hpp"
 
 namespace jay {
@@ -14,6 +16,14 @@ using Json = nlohmann::json;
 using Real = Json::number_float_t;
 using Int = Json::number_integer_t;
 using UInt = Json::number_unsigned_t;
+
+// The maximum nesting depth of arrays and objects accepted by the streaming readers,
+// which bounds the depth of recursion when decoding untrusted input.
+inline constexpr std::size_t default_max_depth = 512;
+
+// A specialization of `nlohmann::basic_json`, e.g. `Json` or `ArenaJson`.
+template<typename T>
+concept BasicJson = nlohmann::detail::is_basic_json<T>::value;
 } // namespace jay
 
 #endif // INCLUDE_JAYBIRD_BASE_DEFS_HPP
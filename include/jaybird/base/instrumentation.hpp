@@ -0,0 +1,336 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_BASE_INSTRUMENTATION_HPP
+#define INCLUDE_JAYBIRD_BASE_INSTRUMENTATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "jaybird/base/defs.hpp"
+
+// Counters for the calls, bytes, time, and failures of encoding and decoding, which are kept
+// for each `serial_name` of a type with a converter and for `read_file`.
+// They are only collected if `JAYBIRD_INSTRUMENTATION` is defined to a non-zero value,
+// as otherwise all hooks are empty and compile away.
+#ifndef JAYBIRD_INSTRUMENTATION
+#define JAYBIRD_INSTRUMENTATION 0
+#endif
+
+namespace jay {
+inline constexpr bool instrumentation_enabled = JAYBIRD_INSTRUMENTATION != 0;
+
+enum struct Operation : unsigned char { encode, decode };
+
+struct OperationStats {
+  std::uint64_t calls{0};
+  // The number of input bytes, which is only known for readers with a position and files.
+  std::uint64_t bytes{0};
+  // The wall time including nested values, i.e. the time of a type contains that of its members.
+  std::uint64_t nanoseconds{0};
+  std::uint64_t failures{0};
+
+  OperationStats& operator+=(const OperationStats& other) {
+    calls += other.calls;
+    bytes += other.bytes;
+    nanoseconds += other.nanoseconds;
+    failures += other.failures;
+    return *this;
+  }
+};
+struct TypeStats {
+  OperationStats encode{};
+  OperationStats decode{};
+
+  OperationStats& operator[](Operation op) {
+    return op == Operation::encode ? encode : decode;
+  }
+};
+using Statistics = std::map<std::string, TypeStats, std::less<>>;
+
+namespace detail {
+// The counters of one thread, which are only written by the thread itself, so that relaxed
+// loads and stores suffice, and are read when the statistics are collected.
+struct ThreadCounters {
+  struct Counters {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> nanoseconds{0};
+    std::atomic<std::uint64_t> failures{0};
+  };
+  // The counters of a slot for each operation.
+  using Slot = std::array<Counters, 2>;
+  static constexpr std::size_t block_size = 64;
+  static constexpr std::size_t block_num = 64;
+  using Block = std::array<Slot, block_size>;
+
+  ThreadCounters();
+  ThreadCounters(const ThreadCounters&) = delete;
+  ThreadCounters(ThreadCounters&&) = delete;
+  ThreadCounters& operator=(const ThreadCounters&) = delete;
+  ThreadCounters& operator=(ThreadCounters&&) = delete;
+  ~ThreadCounters();
+
+  // Blocks are allocated on first use and never moved, so that they can be read concurrently.
+  Counters& at(std::size_t slot, Operation op) {
+    std::atomic<Block*>& block = blocks_[slot / block_size];
+    Block* ptr = block.load(std::memory_order_relaxed);
+    if (ptr == nullptr) {
+      ptr = new Block{};
+      block.store(ptr, std::memory_order_release);
+    }
+    return (*ptr)[slot % block_size][static_cast<std::size_t>(op)];
+  }
+
+  template<typename TOp>
+  void for_each(TOp op) const {
+    for (std::size_t i = 0; i < block_num; ++i) {
+      if (const Block* ptr = blocks_[i].load(std::memory_order_acquire); ptr != nullptr) {
+        for (std::size_t j = 0; j < block_size; ++j) {
+          op(i * block_size + j, (*ptr)[j]);
+        }
+      }
+    }
+  }
+
+private:
+  std::array<std::atomic<Block*>, block_num> blocks_{};
+};
+
+// The names of the slots, the counters of all running threads, and the counters of the threads
+// which have exited.
+struct InstrumentationRegistry {
+  std::mutex mutex{};
+  std::vector<std::string> names{};
+  std::vector<ThreadCounters*> threads{};
+  std::vector<TypeStats> retired{};
+
+  static InstrumentationRegistry& instance() {
+    static InstrumentationRegistry registry{};
+    return registry;
+  }
+
+  // Returns the slot of a name, which is added if it does not exist.
+  std::size_t slot(std::string_view name) {
+    const std::lock_guard lock{mutex};
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      if (names[i] == name) {
+        return i;
+      }
+    }
+    if (names.size() == ThreadCounters::block_size * ThreadCounters::block_num) {
+      throw std::length_error{"Too many instrumented names!"};
+    }
+    names.emplace_back(name);
+    retired.emplace_back();
+    return names.size() - 1;
+  }
+
+  static void add(TypeStats& stats, const ThreadCounters::Slot& slot) {
+    for (const Operation op : {Operation::encode, Operation::decode}) {
+      const auto& counters = slot[static_cast<std::size_t>(op)];
+      stats[op] += {counters.calls.load(std::memory_order_relaxed),
+                    counters.bytes.load(std::memory_order_relaxed),
+                    counters.nanoseconds.load(std::memory_order_relaxed),
+                    counters.failures.load(std::memory_order_relaxed)};
+    }
+  }
+};
+
+inline ThreadCounters::ThreadCounters() {
+  auto& registry = InstrumentationRegistry::instance();
+  const std::lock_guard lock{registry.mutex};
+  registry.threads.push_back(this);
+}
+inline ThreadCounters::~ThreadCounters() {
+  auto& registry = InstrumentationRegistry::instance();
+  {
+    const std::lock_guard lock{registry.mutex};
+    for_each([&](std::size_t slot, const Slot& counters) {
+      if (slot < registry.retired.size()) {
+        InstrumentationRegistry::add(registry.retired[slot], counters);
+      }
+    });
+    std::erase(registry.threads, this);
+  }
+  for (auto& block : blocks_) {
+    delete block.load(std::memory_order_relaxed);
+  }
+}
+
+inline ThreadCounters& thread_counters() {
+  thread_local ThreadCounters counters{};
+  return counters;
+}
+
+// Records a call when destroyed, which is a failure if it ends with an exception.
+// Default-constructed probes record nothing, which are used in constant expressions.
+struct Probe {
+  constexpr Probe() = default;
+  Probe(std::size_t slot, Operation op)
+      : counters_{&thread_counters().at(slot, op)}, exceptions_{std::uncaught_exceptions()},
+        begin_{std::chrono::steady_clock::now()} {}
+  Probe(const Probe&) = delete;
+  Probe(Probe&&) = delete;
+  Probe& operator=(const Probe&) = delete;
+  Probe& operator=(Probe&&) = delete;
+  constexpr ~Probe() {
+    if (counters_ == nullptr) {
+      return;
+    }
+    const auto time = std::chrono::steady_clock::now() - begin_;
+    increment(counters_->calls, 1);
+    increment(counters_->bytes, bytes_);
+    increment(counters_->nanoseconds,
+              static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(time).count()));
+    if (failed_ || std::uncaught_exceptions() > exceptions_) {
+      increment(counters_->failures, 1);
+    }
+  }
+
+  constexpr void add_bytes(std::size_t bytes) {
+    bytes_ += bytes;
+  }
+  constexpr void fail() {
+    failed_ = true;
+  }
+
+private:
+  static void increment(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  ThreadCounters::Counters* counters_{nullptr};
+  int exceptions_{0};
+  std::chrono::steady_clock::time_point begin_{};
+  std::uint64_t bytes_{0};
+  bool failed_{false};
+};
+
+struct NullProbe {
+  constexpr void add_bytes(std::size_t /*bytes*/) {}
+  constexpr void fail() {}
+};
+
+// Adds the input consumed by a reader during its lifetime to a probe, if the reader provides
+// its position.
+template<typename TReader, typename TProbe>
+struct ReadBytes {
+  ReadBytes(const TReader& /*reader*/, TProbe& /*probe*/) {}
+};
+template<typename TReader>
+requires requires(const TReader& reader) { reader.position(); }
+struct ReadBytes<TReader, Probe> {
+  ReadBytes(const TReader& reader, Probe& probe)
+      : reader_{reader}, probe_{probe}, begin_{reader.position()} {}
+  ReadBytes(const ReadBytes&) = delete;
+  ReadBytes(ReadBytes&&) = delete;
+  ReadBytes& operator=(const ReadBytes&) = delete;
+  ReadBytes& operator=(ReadBytes&&) = delete;
+  ~ReadBytes() {
+    probe_.add_bytes(reader_.position() - begin_);
+  }
+
+private:
+  const TReader& reader_;
+  Probe& probe_;
+  std::size_t begin_;
+};
+
+// The hook for an operation on the values with the name returned by `TName`, where each name
+// is registered once per call site.
+template<typename TName>
+constexpr auto probe(Operation op, TName /*name*/) {
+  if constexpr (instrumentation_enabled) {
+    if consteval {
+      return Probe{};
+    } else {
+      static const std::size_t slot = InstrumentationRegistry::instance().slot(TName{}());
+      return Probe{slot, op};
+    }
+  } else {
+    return NullProbe{};
+  }
+}
+} // namespace detail
+
+// The counters of all threads, merged by name, which is empty without instrumentation.
+inline Statistics collect_statistics() {
+  Statistics out{};
+  if constexpr (instrumentation_enabled) {
+    auto& registry = detail::InstrumentationRegistry::instance();
+    const std::lock_guard lock{registry.mutex};
+    std::vector<TypeStats> stats = registry.retired;
+    for (const detail::ThreadCounters* counters : registry.threads) {
+      counters->for_each([&](std::size_t slot, const detail::ThreadCounters::Slot& values) {
+        if (slot < stats.size()) {
+          detail::InstrumentationRegistry::add(stats[slot], values);
+        }
+      });
+    }
+    for (std::size_t i = 0; i < stats.size(); ++i) {
+      out.emplace(registry.names[i], stats[i]);
+    }
+  }
+  return out;
+}
+
+// Sets all counters to zero, where calls which are running concurrently may be lost.
+inline void reset_statistics() {
+  if constexpr (instrumentation_enabled) {
+    auto& registry = detail::InstrumentationRegistry::instance();
+    const std::lock_guard lock{registry.mutex};
+    std::fill(registry.retired.begin(), registry.retired.end(), TypeStats{});
+    for (detail::ThreadCounters* counters : registry.threads) {
+      counters->for_each([](std::size_t /*slot*/, const detail::ThreadCounters::Slot& values) {
+        for (auto& value : const_cast<detail::ThreadCounters::Slot&>(values)) {
+          value.calls.store(0, std::memory_order_relaxed);
+          value.bytes.store(0, std::memory_order_relaxed);
+          value.nanoseconds.store(0, std::memory_order_relaxed);
+          value.failures.store(0, std::memory_order_relaxed);
+        }
+      });
+    }
+  }
+}
+
+// The statistics as a JSON object with an object for each name and operation.
+inline Json statistics_json(const Statistics& stats) {
+  auto out = Json::object();
+  for (const auto& [name, type_stats] : stats) {
+    auto& entry = out[name];
+    for (const auto& [op_name, op_stats] :
+         {std::pair{"encode", type_stats.encode}, std::pair{"decode", type_stats.decode}}) {
+      entry[op_name] = {{"calls", op_stats.calls},
+                        {"bytes", op_stats.bytes},
+                        {"nanoseconds", op_stats.nanoseconds},
+                        {"failures", op_stats.failures}};
+    }
+  }
+  return out;
+}
+inline Json statistics_json() {
+  return statistics_json(collect_statistics());
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_BASE_INSTRUMENTATION_HPP
@@ -0,0 +1,135 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_BASE_INTERN_HPP
+#define INCLUDE_JAYBIRD_BASE_INTERN_HPP
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "ankerl/unordered_dense.h"
+
+namespace jay {
+// Stores each distinct string once, where the stored strings remain valid and unchanged
+// until the pool is destroyed.
+// Pools are not synchronized, i.e. each thread which decodes needs its own pool.
+struct InternPool {
+  explicit InternPool(std::size_t initial_size = 65536) : storage_{initial_size} {}
+  InternPool(const InternPool&) = delete;
+  InternPool(InternPool&&) = delete;
+  InternPool& operator=(const InternPool&) = delete;
+  InternPool& operator=(InternPool&&) = delete;
+  ~InternPool() = default;
+
+  // Returns the stored string equal to `str`, which is added if it does not exist.
+  std::string_view intern(std::string_view str) {
+    if (const auto it = strings_.find(str); it != strings_.end()) {
+      return *it;
+    }
+    auto* data = static_cast<char*>(storage_.allocate(std::max<std::size_t>(str.size(), 1), 1));
+    std::ranges::copy(str, data);
+    const std::string_view stored{data, str.size()};
+    strings_.insert(stored);
+    bytes_ += str.size();
+    return stored;
+  }
+
+  // The number of distinct strings.
+  [[nodiscard]] std::size_t size() const {
+    return strings_.size();
+  }
+  // The number of characters stored.
+  [[nodiscard]] std::size_t bytes() const {
+    return bytes_;
+  }
+
+private:
+  std::pmr::monotonic_buffer_resource storage_;
+  ankerl::unordered_dense::set<std::string_view> strings_{};
+  std::size_t bytes_{0};
+};
+
+// The pool used when decoding `InternedString`s on this thread, if there is one.
+inline InternPool*& current_intern_pool() {
+  thread_local InternPool* pool = nullptr;
+  return pool;
+}
+
+// Makes a pool the current intern pool of this thread until the end of the scope.
+struct InternScope {
+  explicit InternScope(InternPool& pool) : previous_{std::exchange(current_intern_pool(), &pool)} {}
+  InternScope(const InternScope&) = delete;
+  InternScope(InternScope&&) = delete;
+  InternScope& operator=(const InternScope&) = delete;
+  InternScope& operator=(InternScope&&) = delete;
+  ~InternScope() {
+    current_intern_pool() = previous_;
+  }
+
+private:
+  InternPool* previous_;
+};
+
+// A string which is stored in the current `InternPool` when it is decoded, i.e. equal strings
+// share their storage, which is meant for members with few distinct values (e.g. labels or
+// identifiers) and keys of maps. The pool needs to outlive the string.
+// Strings are compared by their contents, i.e. like `std::string`.
+struct InternedString {
+  constexpr InternedString() = default;
+  // Wraps a string which needs to outlive this object, e.g. one stored in a pool.
+  explicit constexpr InternedString(std::string_view view) : view_{view} {}
+
+  // Stores `str` in the current pool.
+  static InternedString intern(std::string_view str) {
+    InternPool* pool = current_intern_pool();
+    if (pool == nullptr) {
+      throw std::logic_error{"Decoding an InternedString requires an InternScope!"};
+    }
+    return InternedString{pool->intern(str)};
+  }
+
+  [[nodiscard]] constexpr std::string_view view() const {
+    return view_;
+  }
+  constexpr operator std::string_view() const { // NOLINT
+    return view_;
+  }
+
+  friend constexpr bool operator==(InternedString a, InternedString b) {
+    return a.view_ == b.view_;
+  }
+  friend constexpr std::strong_ordering operator<=>(InternedString a, InternedString b) {
+    return a.view_ <=> b.view_;
+  }
+
+private:
+  std::string_view view_{};
+};
+} // namespace jay
+
+template<>
+struct std::hash<jay::InternedString> {
+  std::size_t operator()(jay::InternedString str) const noexcept {
+    return std::hash<std::string_view>{}(str.view());
+  }
+};
+template<>
+struct ankerl::unordered_dense::hash<jay::InternedString> {
+  using is_avalanching = void;
+
+  std::uint64_t operator()(jay::InternedString str) const noexcept {
+    return ankerl::unordered_dense::hash<std::string_view>{}(str.view());
+  }
+};
+
+#endif // INCLUDE_JAYBIRD_BASE_INTERN_HPP
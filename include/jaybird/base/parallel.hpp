@@ -0,0 +1,193 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_BASE_PARALLEL_HPP
+#define INCLUDE_JAYBIRD_BASE_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jay {
+// The layout of a sequence of records.
+enum struct RecordLayout {
+  // When reading, a top-level array if the first non-whitespace character is `[` and
+  // JSON Lines otherwise; when writing, a top-level array.
+  detect,
+  json_lines,
+  array,
+};
+
+struct ParallelOptions {
+  // The number of worker threads, where 0 uses one per hardware thread.
+  std::size_t thread_num = 0;
+  // The approximate number of bytes processed by each task.
+  std::size_t chunk_size = std::size_t{1} << 20U;
+  // Whether results are passed on in their original order instead of as they are finished.
+  bool ordered = true;
+
+  [[nodiscard]] std::size_t effective_thread_num() const {
+    if (thread_num > 0) {
+      return thread_num;
+    }
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  }
+};
+
+// Calls `op(i)` for `i` from 0 to `size - 1` on up to `thread_num` threads, rethrowing
+// the first exception once all threads are finished.
+template<typename TOp>
+inline void parallel_for(std::size_t thread_num, std::size_t size, TOp op) {
+  thread_num = std::min(thread_num, size);
+  if (thread_num <= 1) {
+    for (std::size_t i = 0; i < size; ++i) {
+      op(i);
+    }
+    return;
+  }
+
+  std::atomic<std::size_t> next{0};
+  std::exception_ptr error{};
+  std::mutex error_mutex{};
+  auto work = [&] {
+    try {
+      for (std::size_t i = next++; i < size; i = next++) {
+        op(i);
+      }
+    } catch (...) {
+      next = size;
+      const std::scoped_lock lock{error_mutex};
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+  {
+    std::vector<std::jthread> threads{};
+    threads.reserve(thread_num - 1);
+    for (std::size_t t = 1; t < thread_num; ++t) {
+      threads.emplace_back(work);
+    }
+    work();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+// Calls `produce(i)` for `i` from 0 to `size - 1` on worker threads and passes the results
+// to `consume` on the calling thread, in the order of `i` if `options.ordered` is set and
+// as they are finished otherwise.
+// At most two results per thread are produced but not yet consumed at any time, and the first
+// exception (in the order of consumption) is rethrown once the workers have stopped.
+template<typename TProduce, typename TConsume>
+inline void parallel_pipeline(std::size_t size, TProduce produce, TConsume consume,
+                              const ParallelOptions& options) {
+  using Result = std::invoke_result_t<TProduce&, std::size_t>;
+  const std::size_t thread_num = std::min(options.effective_thread_num(), size);
+  if (thread_num <= 1) {
+    for (std::size_t i = 0; i < size; ++i) {
+      consume(produce(i));
+    }
+    return;
+  }
+
+  struct Slot {
+    std::optional<Result> result{};
+    std::exception_ptr error{};
+    bool done = false;
+  };
+  std::vector<Slot> slots(size);
+  std::deque<std::size_t> finished{};
+  std::mutex mutex{};
+  std::condition_variable worker_cv{};
+  std::condition_variable main_cv{};
+  std::size_t next = 0;
+  std::size_t in_flight = 0;
+  bool stop = false;
+  const std::size_t window = 2 * thread_num;
+
+  auto work = [&] {
+    for (;;) {
+      std::size_t idx = 0;
+      {
+        std::unique_lock lock{mutex};
+        worker_cv.wait(lock, [&] { return stop || next == size || in_flight < window; });
+        if (stop || next == size) {
+          return;
+        }
+        idx = next++;
+        ++in_flight;
+      }
+      Slot& slot = slots[idx];
+      try {
+        slot.result.emplace(produce(idx));
+      } catch (...) {
+        slot.error = std::current_exception();
+      }
+      {
+        const std::scoped_lock lock{mutex};
+        slot.done = true;
+        if (!options.ordered) {
+          finished.push_back(idx);
+        }
+      }
+      main_cv.notify_one();
+    }
+  };
+  auto take = [&](std::size_t consumed) {
+    std::unique_lock lock{mutex};
+    std::size_t idx = consumed;
+    if (options.ordered) {
+      main_cv.wait(lock, [&] { return slots[idx].done; });
+    } else {
+      main_cv.wait(lock, [&] { return !finished.empty(); });
+      idx = finished.front();
+      finished.pop_front();
+    }
+    --in_flight;
+    worker_cv.notify_one();
+    return std::exchange(slots[idx], Slot{.done = true});
+  };
+  auto finish = [&] {
+    {
+      const std::scoped_lock lock{mutex};
+      stop = true;
+    }
+    worker_cv.notify_all();
+  };
+
+  std::vector<std::jthread> threads{};
+  threads.reserve(thread_num);
+  for (std::size_t t = 0; t < thread_num; ++t) {
+    threads.emplace_back(work);
+  }
+  try {
+    for (std::size_t consumed = 0; consumed < size; ++consumed) {
+      Slot slot = take(consumed);
+      if (slot.error) {
+        std::rethrow_exception(slot.error);
+      }
+      consume(std::move(*slot.result));
+    }
+  } catch (...) {
+    finish();
+    throw;
+  }
+  finish();
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_BASE_PARALLEL_HPP
@@ -0,0 +1,132 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_BASE_PERFECT_HASH_HPP
+#define INCLUDE_JAYBIRD_BASE_PERFECT_HASH_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace jay {
+// A perfect hash function over a fixed set of distinct strings, which is constructed at compile
+// time using hash-and-displace: Each key is assigned to a bucket by its hash, and each bucket
+// stores a displacement chosen such that all keys end up in different slots.
+// A lookup hashes the key once and compares it with the single candidate in its slot.
+template<std::size_t tSize>
+struct PerfectHash {
+  static constexpr std::size_t bucket_num = std::bit_ceil(std::max<std::size_t>(tSize / 2, 1));
+  static constexpr std::size_t slot_num = std::bit_ceil(std::max<std::size_t>(2 * tSize, 1));
+
+  constexpr explicit PerfectHash(const std::array<std::string_view, tSize>& keys) : keys_{keys} {
+    std::array<std::uint64_t, tSize> hashes{};
+    std::array<std::size_t, bucket_num> bucket_sizes{};
+    for (std::size_t i = 0; i < tSize; ++i) {
+      for (std::size_t j = 0; j < i; ++j) {
+        if (keys[i] == keys[j]) {
+          throw std::invalid_argument{"The keys of a perfect hash need to be distinct!"};
+        }
+      }
+      hashes[i] = hash(keys[i]);
+      ++bucket_sizes[bucket_of(hashes[i])];
+    }
+
+    // Place the largest buckets first, as they are the hardest to fit
+    std::array<std::size_t, bucket_num> buckets{};
+    for (std::size_t i = 0; i < bucket_num; ++i) {
+      buckets[i] = i;
+    }
+    std::sort(buckets.begin(), buckets.end(), [&](std::size_t a, std::size_t b) {
+      return bucket_sizes[a] > bucket_sizes[b] || (bucket_sizes[a] == bucket_sizes[b] && a < b);
+    });
+
+    slots_.fill(tSize);
+    for (const std::size_t bucket : buckets) {
+      if (bucket_sizes[bucket] == 0) {
+        break;
+      }
+      for (std::uint64_t displacement = 0;; ++displacement) {
+        if (try_place(hashes, bucket, displacement)) {
+          displacements_[bucket] = displacement;
+          break;
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] constexpr std::optional<std::size_t> find(std::string_view key) const {
+    if constexpr (tSize == 0) {
+      return std::nullopt;
+    } else {
+      const std::uint64_t h = hash(key);
+      const std::size_t idx = slots_[slot_of(h, displacements_[bucket_of(h)])];
+      if (idx < tSize && keys_[idx] == key) {
+        return idx;
+      }
+      return std::nullopt;
+    }
+  }
+
+  [[nodiscard]] constexpr const std::array<std::string_view, tSize>& keys() const {
+    return keys_;
+  }
+
+  // FNV-1a
+  static constexpr std::uint64_t hash(std::string_view key) {
+    std::uint64_t h = 0xCBF29CE484222325U;
+    for (const char c : key) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 0x100000001B3U;
+    }
+    return h;
+  }
+
+private:
+  static constexpr std::size_t bucket_of(std::uint64_t h) {
+    return (h >> 40U) & (bucket_num - 1);
+  }
+  // The finalizer of SplitMix64
+  static constexpr std::size_t slot_of(std::uint64_t h, std::uint64_t displacement) {
+    h ^= displacement * 0x9E3779B97F4A7C15U;
+    h = (h ^ (h >> 30U)) * 0xBF58476D1CE4E5B9U;
+    h = (h ^ (h >> 27U)) * 0x94D049BB133111EBU;
+    h ^= h >> 31U;
+    return h & (slot_num - 1);
+  }
+
+  constexpr bool try_place(const std::array<std::uint64_t, tSize>& hashes, std::size_t bucket,
+                           std::uint64_t displacement) {
+    std::array<std::size_t, tSize> placed{};
+    std::size_t placed_num = 0;
+    for (std::size_t i = 0; i < tSize; ++i) {
+      if (bucket_of(hashes[i]) != bucket) {
+        continue;
+      }
+      const std::size_t slot = slot_of(hashes[i], displacement);
+      if (slots_[slot] != tSize) {
+        for (std::size_t j = 0; j < placed_num; ++j) {
+          slots_[placed[j]] = tSize;
+        }
+        return false;
+      }
+      slots_[slot] = i;
+      placed[placed_num++] = slot;
+    }
+    return true;
+  }
+
+  std::array<std::string_view, tSize> keys_;
+  std::array<std::uint64_t, bucket_num> displacements_{};
+  std::array<std::size_t, slot_num> slots_{};
+};
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_BASE_PERFECT_HASH_HPP
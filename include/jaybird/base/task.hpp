@@ -0,0 +1,130 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_BASE_TASK_HPP
+#define INCLUDE_JAYBIRD_BASE_TASK_HPP
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <variant>
+
+namespace jay {
+template<typename T>
+struct Task;
+
+namespace detail {
+struct SyncState {
+  std::mutex mutex{};
+  std::condition_variable condition{};
+  bool done{false};
+};
+
+template<typename T>
+struct TaskPromise {
+  // Resumes the awaiting coroutine or signals `sync_wait` once the task is complete.
+  struct FinalAwaiter {
+    static bool await_ready() noexcept {
+      return false;
+    }
+    static std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<TaskPromise> handle) noexcept {
+      // The frame may be destroyed by `sync_wait` as soon as it is signalled
+      const std::coroutine_handle<> continuation = handle.promise().continuation;
+      if (SyncState* sync = handle.promise().sync; sync != nullptr) {
+        const std::lock_guard lock{sync->mutex};
+        sync->done = true;
+        sync->condition.notify_one();
+      }
+      return continuation;
+    }
+    static void await_resume() noexcept {}
+  };
+
+  Task<T> get_return_object() noexcept {
+    return Task<T>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+  }
+  static std::suspend_always initial_suspend() noexcept {
+    return {};
+  }
+  static FinalAwaiter final_suspend() noexcept {
+    return {};
+  }
+
+  template<typename TValue>
+  void return_value(TValue&& value) {
+    result.template emplace<1>(std::forward<TValue>(value));
+  }
+  void unhandled_exception() noexcept {
+    result.template emplace<2>(std::current_exception());
+  }
+
+  T get() {
+    if (result.index() == 2) {
+      std::rethrow_exception(std::get<2>(result));
+    }
+    return std::move(std::get<1>(result));
+  }
+
+  std::coroutine_handle<> continuation{std::noop_coroutine()};
+  SyncState* sync{nullptr};
+  std::variant<std::monostate, T, std::exception_ptr> result{};
+};
+} // namespace detail
+
+// A lazily started coroutine which produces a `T` and resumes its awaiter once it is complete.
+// Exceptions are propagated to the awaiter.
+template<typename T>
+struct [[nodiscard]] Task {
+  using promise_type = detail::TaskPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  explicit Task(Handle handle) : handle_{handle} {}
+  Task(const Task&) = delete;
+  Task(Task&& other) noexcept : handle_{std::exchange(other.handle_, {})} {}
+  Task& operator=(const Task&) = delete;
+  Task& operator=(Task&& other) noexcept {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  [[nodiscard]] bool await_ready() const noexcept {
+    return false;
+  }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+    handle_.promise().continuation = awaiter;
+    return handle_;
+  }
+  T await_resume() {
+    return handle_.promise().get();
+  }
+
+  // Runs the task and blocks until it is complete, which can happen on another thread
+  // if the task awaits operations which complete there.
+  friend T sync_wait(Task task) {
+    detail::SyncState sync{};
+    task.handle_.promise().sync = &sync;
+    task.handle_.resume();
+    {
+      std::unique_lock lock{sync.mutex};
+      sync.condition.wait(lock, [&] { return sync.done; });
+    }
+    return task.handle_.promise().get();
+  }
+
+private:
+  Handle handle_;
+};
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_BASE_TASK_HPP
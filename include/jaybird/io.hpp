@@ -2,7 +2,13 @@
 #define INCLUDE_JAYBIRD_IO_HPP
 
 // IWYU pragma: begin_exports
+#include "io/file-contents.hpp"
+#include "io/incremental.hpp"
 #include "io/io.hpp"
+#include "io/json-lines.hpp"
+#include "io/lazy-document.hpp"
+#include "io/live-config.hpp"
+#include "io/parallel-read.hpp"
 // IWYU pragma: end_exports
 
 #endif // INCLUDE_JAYBIRD_IO_HPP
@@ -0,0 +1,185 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_IO_FILE_CONTENTS_HPP
+#define INCLUDE_JAYBIRD_IO_FILE_CONTENTS_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define JAYBIRD_HAS_MMAP 1
+#else
+#define JAYBIRD_HAS_MMAP 0
+#endif
+
+#include "thesauros/format.hpp"
+
+namespace jay {
+#if JAYBIRD_HAS_MMAP
+namespace detail {
+// Closes a file descriptor when it goes out of scope.
+struct FileDescriptor {
+  explicit FileDescriptor(int fd) : fd_{fd} {}
+  FileDescriptor(const FileDescriptor&) = delete;
+  FileDescriptor(FileDescriptor&&) = delete;
+  FileDescriptor& operator=(const FileDescriptor&) = delete;
+  FileDescriptor& operator=(FileDescriptor&&) = delete;
+  ~FileDescriptor() {
+    ::close(fd_);
+  }
+
+  [[nodiscard]] int get() const {
+    return fd_;
+  }
+
+private:
+  int fd_;
+};
+} // namespace detail
+#endif
+
+// The complete contents of a file.
+// Regular files are memory-mapped, whereas everything else (e.g. pipes) and files which
+// cannot be mapped are read into a buffer in large chunks.
+struct FileContents {
+  static constexpr std::size_t chunk_size = 65536;
+
+  explicit FileContents(const std::filesystem::path& path) {
+#if JAYBIRD_HAS_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error{errno, std::generic_category(),
+                              fmt::format("Opening {} failed", path.string())};
+    }
+    const detail::FileDescriptor file{fd};
+    if (!map(file.get(), 0)) {
+      read_all(file.get());
+    }
+#else
+    std::FILE* handle = std::fopen(path.string().c_str(), "rb");
+    if (handle == nullptr) {
+      throw std::system_error{errno, std::generic_category(),
+                              fmt::format("Opening {} failed", path.string())};
+    }
+    read_all(handle);
+    std::fclose(handle);
+#endif
+  }
+  // Reads the remaining contents of an open file.
+  // Regular files are mapped from the current position, after which the file is at its end.
+  explicit FileContents(std::FILE* handle) {
+#if JAYBIRD_HAS_MMAP
+    const long pos = std::ftell(handle);
+    if (pos >= 0 && std::fflush(handle) == 0 &&
+        map(::fileno(handle), static_cast<std::size_t>(pos))) {
+      std::fseek(handle, 0, SEEK_END);
+      return;
+    }
+#endif
+    read_all(handle);
+  }
+
+  FileContents(const FileContents&) = delete;
+  FileContents(FileContents&&) = delete;
+  FileContents& operator=(const FileContents&) = delete;
+  FileContents& operator=(FileContents&&) = delete;
+  ~FileContents() {
+#if JAYBIRD_HAS_MMAP
+    if (mapping_ != nullptr) {
+      ::munmap(mapping_, mapping_size_);
+    }
+#endif
+  }
+
+  [[nodiscard]] std::string_view view() const {
+    return {data_, size_};
+  }
+  [[nodiscard]] bool is_mapped() const {
+    return mapping_ != nullptr;
+  }
+
+private:
+#if JAYBIRD_HAS_MMAP
+  // Maps a regular file from `offset` to its end, returning whether this has succeeded.
+  bool map(int fd, std::size_t offset) {
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+      return false;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    if (offset >= size) {
+      return false;
+    }
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      buffer_.reserve(size - offset);
+      return false;
+    }
+    ::madvise(data, size, MADV_SEQUENTIAL);
+    mapping_ = data;
+    mapping_size_ = size;
+    data_ = static_cast<const char*>(data) + offset;
+    size_ = size - offset;
+    return true;
+  }
+  void read_all(int fd) {
+    for (;;) {
+      const std::size_t offset = buffer_.size();
+      buffer_.resize(offset + chunk_size);
+      const ::ssize_t num = ::read(fd, buffer_.data() + offset, chunk_size);
+      if (num < 0 && errno == EINTR) {
+        buffer_.resize(offset);
+        continue;
+      }
+      if (num < 0) {
+        throw std::system_error{errno, std::generic_category(), "Reading a file failed"};
+      }
+      buffer_.resize(offset + static_cast<std::size_t>(num));
+      if (num == 0) {
+        break;
+      }
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+  }
+#endif
+  void read_all(std::FILE* handle) {
+    for (;;) {
+      const std::size_t offset = buffer_.size();
+      buffer_.resize(offset + chunk_size);
+      const std::size_t num = std::fread(buffer_.data() + offset, 1, chunk_size, handle);
+      buffer_.resize(offset + num);
+      if (num < chunk_size) {
+        break;
+      }
+    }
+    if (std::ferror(handle) != 0) {
+      throw std::runtime_error{"Reading a file failed!"};
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+  }
+
+  const char* data_{nullptr};
+  std::size_t size_{0};
+  std::string buffer_{};
+  void* mapping_{nullptr};
+  std::size_t mapping_size_{0};
+};
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_IO_FILE_CONTENTS_HPP
@@ -0,0 +1,195 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_IO_INCREMENTAL_HPP
+#define INCLUDE_JAYBIRD_IO_INCREMENTAL_HPP
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include "jaybird/base/task.hpp"
+#include "jaybird/serialization/serialization.hpp"
+
+namespace jay {
+// Decodes a stream of JSON values separated by whitespace (e.g. JSON Lines) which arrives
+// in chunks of arbitrary size, e.g. from a pipe or a socket.
+// Each value is decoded as soon as its last character has been fed, directly from the chunk
+// if it is contained in it. Only the part of a value which spans chunks is buffered,
+// so that the memory used is bounded by the size of a chunk and the longest value.
+// The chunks are only scanned for the extent of each value, i.e. for brackets and strings,
+// and syntax errors are reported when decoding the value.
+template<typename T>
+struct IncrementalParser {
+  // Scans a chunk, decoding all values which end within it, and returns their number.
+  std::size_t feed(std::span<const char> chunk) {
+    const std::string_view text{chunk.data(), chunk.size()};
+    const std::size_t before = values_.size();
+    // The beginning of the current value within the chunk, where the part in previous chunks
+    // is in `buffer_`
+    std::size_t begin = 0;
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+      switch (state_) {
+        case State::between: {
+          pos = text.find_first_not_of(" \t\n\r", pos);
+          if (pos == std::string_view::npos) {
+            return values_.size() - before;
+          }
+          begin = pos;
+          const char c = text[pos++];
+          if (c == '{' || c == '[') {
+            state_ = State::container;
+            depth_ = 1;
+          } else if (c == '"') {
+            state_ = State::string;
+          } else {
+            state_ = State::scalar;
+          }
+          break;
+        }
+        case State::container: {
+          pos = text.find_first_of("{}[]\"", pos);
+          if (pos == std::string_view::npos) {
+            break;
+          }
+          const char c = text[pos++];
+          if (c == '"') {
+            state_ = State::string;
+          } else if (c == '{' || c == '[') {
+            ++depth_;
+          } else if (--depth_ == 0) {
+            complete(text.substr(begin, pos - begin));
+          }
+          break;
+        }
+        case State::string: {
+          if (escaped_) {
+            escaped_ = false;
+            ++pos;
+            break;
+          }
+          pos = text.find_first_of("\"\\", pos);
+          if (pos == std::string_view::npos) {
+            break;
+          }
+          if (text[pos++] == '\\') {
+            escaped_ = true;
+          } else if (depth_ == 0) {
+            complete(text.substr(begin, pos - begin));
+          } else {
+            state_ = State::container;
+          }
+          break;
+        }
+        case State::scalar: {
+          // Numbers and literals end with the first character which cannot be part of them
+          pos = text.find_first_of(" \t\n\r{}[]\",", pos);
+          if (pos == std::string_view::npos) {
+            break;
+          }
+          complete(text.substr(begin, pos - begin));
+          break;
+        }
+      }
+    }
+    if (state_ != State::between) {
+      buffer_.append(text.substr(begin));
+    }
+    return values_.size() - before;
+  }
+
+  // Marks the end of the input, which completes a value without delimiter (e.g. `1`)
+  // and reports an incomplete value as an error of the value.
+  void finish() {
+    if (state_ != State::between) {
+      complete({});
+    }
+    finished_ = true;
+  }
+
+  // The next decoded value, or `std::nullopt` if none is ready.
+  // Values which could not be decoded rethrow the exception in their place.
+  std::optional<T> next() {
+    if (values_.empty()) {
+      return std::nullopt;
+    }
+    auto value = std::move(values_.front());
+    values_.pop_front();
+    if (value.index() == 1) {
+      std::rethrow_exception(std::get<1>(value));
+    }
+    return std::optional<T>{std::in_place, std::move(std::get<0>(value))};
+  }
+
+  // Whether `finish` has been called and all values have been retrieved.
+  [[nodiscard]] bool done() const {
+    return finished_ && values_.empty();
+  }
+  // The number of characters of the incomplete value which are kept.
+  [[nodiscard]] std::size_t buffered() const {
+    return buffer_.size();
+  }
+
+private:
+  enum struct State : unsigned char { between, container, string, scalar };
+
+  // Decodes the value which ends with `tail` and resets the state.
+  void complete(std::string_view tail) {
+    std::string_view text = tail;
+    if (!buffer_.empty()) {
+      buffer_.append(tail);
+      text = buffer_;
+    }
+    try {
+      values_.emplace_back(std::in_place_index<0>, parse<T>(text));
+    } catch (const std::exception& /*ex*/) {
+      values_.emplace_back(std::in_place_index<1>, std::current_exception());
+    }
+    buffer_.clear();
+    state_ = State::between;
+    depth_ = 0;
+    escaped_ = false;
+  }
+
+  std::string buffer_{};
+  State state_{State::between};
+  std::size_t depth_{0};
+  bool escaped_{false};
+  bool finished_{false};
+  std::deque<std::variant<T, std::exception_ptr>> values_{};
+};
+
+// Decodes the next value of a source whose chunks are produced by `co_await read()`,
+// where an empty chunk marks the end, returning `std::nullopt` at the end.
+// A chunk only needs to remain valid until `read` is called again, and the parser and `read`
+// need to outlive the task.
+template<typename T, typename TRead>
+inline Task<std::optional<T>> next_value(IncrementalParser<T>& parser, TRead& read) {
+  while (true) {
+    if (auto value = parser.next()) {
+      co_return value;
+    }
+    if (parser.done()) {
+      co_return std::nullopt;
+    }
+    const std::span<const char> chunk = co_await read();
+    if (chunk.empty()) {
+      parser.finish();
+    } else {
+      parser.feed(chunk);
+    }
+  }
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_IO_INCREMENTAL_HPP
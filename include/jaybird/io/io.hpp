@@ -7,18 +7,201 @@
 #ifndef INCLUDE_JAYBIRD_IO_IO_HPP
 #define INCLUDE_JAYBIRD_IO_IO_HPP
 
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
 
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define JAYBIRD_HAS_UNISTD 1
+#else
+#define JAYBIRD_HAS_UNISTD 0
+#endif
+
+#include "thesauros/format.hpp"
 #include "thesauros/io/file-reader.hpp"
 
 #include "jaybird/base/defs.hpp"
+#include "jaybird/base/instrumentation.hpp"
+#include "jaybird/io/file-contents.hpp"
+#include "jaybird/serialization/codec.hpp"
+#include "jaybird/serialization/serialization.hpp"
+#include "jaybird/serialization/writer.hpp"
 
 namespace jay {
-inline Json read_file(thes::FileReader reader) {
-  return Json::parse(reader.handle());
+namespace detail {
+// Reads and decodes a file, which is instrumented as a whole under the name `read_file`.
+template<typename T, typename TSource>
+inline T read_file_impl(const TSource& source, Format format) {
+  auto probe = detail::probe(Operation::decode, [] { return std::string_view{"read_file"}; });
+  const FileContents contents{source};
+  probe.add_bytes(contents.view().size());
+  return decode<T>(contents.view(), format);
+}
+} // namespace detail
+
+inline Json read_file(thes::FileReader reader, Format format = Format::json) {
+  return detail::read_file_impl<Json>(reader.handle(), format);
+}
+inline Json read_file(const std::filesystem::path& p, Format format = Format::json) {
+  return detail::read_file_impl<Json>(p, format);
 }
-inline Json read_file(const std::filesystem::path& p) {
-  return read_file(thes::FileReader{p});
+
+// Decodes the contents of a file directly into a `T` without building a DOM, see `decode`.
+template<typename T>
+inline T read_file(thes::FileReader reader, Format format = Format::json) {
+  return detail::read_file_impl<T>(reader.handle(), format);
+}
+template<typename T>
+inline T read_file(const std::filesystem::path& p, Format format = Format::json) {
+  return detail::read_file_impl<T>(p, format);
+}
+
+struct WriteOptions {
+  Format format = Format::json;
+  // The indentation used for pretty-printing JSON, or -1 for compact output as in `Json::dump`.
+  int indent = -1;
+  // Whether the data is synchronized to the storage device before the target is replaced.
+  bool sync = false;
+};
+
+namespace detail {
+// A temporary file next to a target which is removed unless it has been committed.
+struct TemporaryFile {
+  // The number of random names which are tried before giving up.
+  static constexpr int attempts = 64;
+
+  explicit TemporaryFile(const std::filesystem::path& target) : target_{target} {
+#if JAYBIRD_HAS_UNISTD
+    // The file is created with mode 0666 so that the kernel applies the umask as for
+    // the target itself, which `mkstemp` (mode 0600) would not
+    const int fd = create();
+    // An existing target keeps its mode
+    struct stat info {};
+    if (::stat(target_.c_str(), &info) == 0 && ::fchmod(fd, info.st_mode & 07777) != 0) {
+      discard(fd, errno);
+    }
+    handle_ = ::fdopen(fd, "wb");
+    if (handle_ == nullptr) {
+      discard(fd, errno);
+    }
+#else
+    path_ = target.string() + ".tmp";
+    handle_ = std::fopen(path_.string().c_str(), "wb");
+    if (handle_ == nullptr) {
+      fail(errno);
+    }
+#endif
+  }
+  TemporaryFile(const TemporaryFile&) = delete;
+  TemporaryFile(TemporaryFile&&) = delete;
+  TemporaryFile& operator=(const TemporaryFile&) = delete;
+  TemporaryFile& operator=(TemporaryFile&&) = delete;
+  ~TemporaryFile() {
+    if (handle_ != nullptr) {
+      std::fclose(handle_);
+    }
+    if (!committed_) {
+      std::error_code ec{};
+      std::filesystem::remove(path_, ec);
+    }
+  }
+
+  [[nodiscard]] std::FILE* handle() const {
+    return handle_;
+  }
+
+  // Closes the file and moves it over the target.
+  void commit(bool sync) {
+    // The first error is reported, as `fclose` may overwrite `errno`
+    int error = 0;
+    if (std::fflush(handle_) != 0) {
+      error = errno;
+    }
+#if JAYBIRD_HAS_UNISTD
+    if (error == 0 && sync && ::fsync(::fileno(handle_)) != 0) {
+      error = errno;
+    }
+#endif
+    if (std::fclose(handle_) != 0 && error == 0) {
+      error = errno;
+    }
+    handle_ = nullptr;
+    if (error != 0) {
+      throw std::system_error{error, std::generic_category(),
+                              fmt::format("Writing {} failed", target_.string())};
+    }
+    std::filesystem::rename(path_, target_);
+    committed_ = true;
+  }
+
+private:
+  [[noreturn]] void fail(int error) const {
+    throw std::system_error{
+      error, std::generic_category(),
+      fmt::format("Creating a temporary file for {} failed", target_.string())};
+  }
+#if JAYBIRD_HAS_UNISTD
+  // Creates a file with a random name next to the target and returns its descriptor.
+  int create() {
+    static constexpr std::string_view alphabet =
+      "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::random_device device{};
+    std::uniform_int_distribution<std::size_t> dist{0, alphabet.size() - 1};
+    std::string name = target_.string() + ".XXXXXX";
+    const std::size_t suffix = name.size() - 6;
+    for (int i = 0; i < attempts; ++i) {
+      for (std::size_t j = suffix; j < name.size(); ++j) {
+        name[j] = alphabet[dist(device)];
+      }
+      const int fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+      if (fd >= 0) {
+        path_ = std::move(name);
+        return fd;
+      }
+      if (errno != EEXIST) {
+        fail(errno);
+      }
+    }
+    fail(EEXIST);
+  }
+  // Closes and removes the file after an error.
+  [[noreturn]] void discard(int fd, int error) const {
+    ::close(fd);
+    ::unlink(path_.c_str());
+    fail(error);
+  }
+#endif
+
+  std::filesystem::path target_;
+  std::filesystem::path path_{};
+  std::FILE* handle_{nullptr};
+  bool committed_{false};
+};
+} // namespace detail
+
+// Writes `value` to a file in the given format without building a DOM or the whole output,
+// i.e. through the fixed-size buffer of `FileSink`, producing the same output as
+// `to_json(value).dump(options.indent)` or `to_cbor`/`to_msgpack`.
+// The text is written to a temporary file in the same directory which replaces the target
+// only once it is complete, so that readers never observe a partially written file.
+template<typename T>
+inline void write_file(const std::filesystem::path& p, const T& value,
+                       const WriteOptions& options = {}) {
+  detail::TemporaryFile file{p};
+  {
+    FileSink sink{file.handle()};
+    encode(sink, value, options.format, options.indent);
+    sink.flush();
+  }
+  file.commit(options.sync);
 }
 } // namespace jay
 
@@ -0,0 +1,223 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_IO_JSON_LINES_HPP
+#define INCLUDE_JAYBIRD_IO_JSON_LINES_HPP
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "thesauros/format.hpp"
+#include "thesauros/io/file-reader.hpp"
+
+#include "jaybird/serialization/serialization.hpp"
+#include "jaybird/serialization/writer.hpp"
+
+namespace jay {
+// A line of a JSON Lines stream which could not be decoded.
+// `text` is only valid during the invocation of the error handler.
+struct LineError {
+  std::size_t line;
+  std::string_view text;
+  std::string message;
+};
+using LineErrorHandler = std::function<void(const LineError&)>;
+
+// Decodes the records of a JSON Lines stream one at a time, where the memory used is bounded
+// by the size of the read buffer and the longest line, which is stored in a reused buffer.
+// Empty lines are ignored and lines which cannot be decoded are passed to the error handler
+// (if there is one) and skipped.
+template<typename T>
+struct JsonLinesReader {
+  static constexpr std::size_t chunk_size = 65536;
+
+  struct Iterator {
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+
+    explicit Iterator(JsonLinesReader& reader) : reader_{&reader} {}
+
+    T& operator*() const {
+      return *reader_->current_;
+    }
+    T* operator->() const {
+      return &*reader_->current_;
+    }
+    Iterator& operator++() {
+      reader_->advance();
+      return *this;
+    }
+    void operator++(int) {
+      ++*this;
+    }
+
+    bool operator==(std::default_sentinel_t /*sentinel*/) const {
+      return !reader_->current_.has_value();
+    }
+
+  private:
+    JsonLinesReader* reader_;
+  };
+
+  explicit JsonLinesReader(thes::FileReader reader, LineErrorHandler on_error = {})
+      : reader_{std::move(reader)}, on_error_{std::move(on_error)} {}
+  explicit JsonLinesReader(const std::filesystem::path& p, LineErrorHandler on_error = {})
+      : JsonLinesReader(thes::FileReader{p}, std::move(on_error)) {}
+
+  // Returns the next record or `std::nullopt` at the end of the stream.
+  std::optional<T> next() {
+    while (read_line()) {
+      std::string_view text{line_};
+      if (text.ends_with('\r')) {
+        text.remove_suffix(1);
+      }
+      if (text.find_first_not_of(" \t") == std::string_view::npos) {
+        continue;
+      }
+      try {
+        return parse<T>(text);
+      } catch (const std::exception& ex) {
+        if (on_error_) {
+          on_error_(LineError{line_num_, text, ex.what()});
+        }
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Iterating over the reader consumes the records.
+  Iterator begin() {
+    advance();
+    return Iterator{*this};
+  }
+  static std::default_sentinel_t end() {
+    return std::default_sentinel;
+  }
+
+  // The number of lines read so far.
+  [[nodiscard]] std::size_t line_num() const {
+    return line_num_;
+  }
+
+private:
+  void advance() {
+    current_ = next();
+  }
+
+  // Stores the next line without the line feed in `line_`, returning false at the end.
+  bool read_line() {
+    line_.clear();
+    bool any = false;
+    for (;;) {
+      if (begin_ == end_ && !refill()) {
+        if (any) {
+          ++line_num_;
+        }
+        return any;
+      }
+      any = true;
+      const char* first = buffer_.data() + begin_;
+      const char* last = buffer_.data() + end_;
+      const char* newline = std::find(first, last, '\n');
+      line_.append(first, newline);
+      if (newline != last) {
+        begin_ = static_cast<std::size_t>(newline - buffer_.data()) + 1;
+        ++line_num_;
+        return true;
+      }
+      begin_ = end_;
+    }
+  }
+  bool refill() {
+    begin_ = 0;
+    end_ = std::fread(buffer_.data(), 1, buffer_.size(), reader_.handle());
+    if (end_ == 0 && std::ferror(reader_.handle()) != 0) {
+      throw std::system_error{errno, std::generic_category(),
+                              fmt::format("Reading line {} failed", line_num_ + 1)};
+    }
+    return end_ > 0;
+  }
+
+  thes::FileReader reader_;
+  LineErrorHandler on_error_;
+  std::array<char, chunk_size> buffer_{};
+  std::size_t begin_{0};
+  std::size_t end_{0};
+  std::string line_{};
+  std::size_t line_num_{0};
+  std::optional<T> current_{};
+};
+
+// Writes records as JSON Lines through the buffer of a `FileSink`, i.e. without building
+// a DOM or a string for each record.
+template<typename T>
+struct JsonLinesWriter {
+  // Writes to an open file, which is not closed by the writer.
+  explicit JsonLinesWriter(std::FILE* handle) : sink_{handle} {}
+  // Creates or truncates the file, or appends to it if `append` is true.
+  explicit JsonLinesWriter(const std::filesystem::path& p, bool append = false)
+      : owned_{open(p, append)}, sink_{owned_} {}
+
+  JsonLinesWriter(const JsonLinesWriter&) = delete;
+  JsonLinesWriter(JsonLinesWriter&&) = delete;
+  JsonLinesWriter& operator=(const JsonLinesWriter&) = delete;
+  JsonLinesWriter& operator=(JsonLinesWriter&&) = delete;
+  ~JsonLinesWriter() {
+    if (owned_ != nullptr) {
+      try {
+        sink_.flush();
+      } catch (const std::exception& /*ex*/) {
+        // Errors can only be observed by calling `flush`
+      }
+      std::fclose(owned_);
+    }
+  }
+
+  void write(const T& record) {
+    write_json(sink_, record);
+    sink_.put('\n');
+  }
+
+  // Hands the buffered records to the file.
+  void flush() {
+    sink_.flush();
+    if (std::fflush(handle()) != 0) {
+      throw std::system_error{errno, std::generic_category(), "Flushing JSON Lines failed"};
+    }
+  }
+
+private:
+  static std::FILE* open(const std::filesystem::path& p, bool append) {
+    std::FILE* handle = std::fopen(p.string().c_str(), append ? "ab" : "wb");
+    if (handle == nullptr) {
+      throw std::system_error{errno, std::generic_category(),
+                              fmt::format("Opening {} failed", p.string())};
+    }
+    return handle;
+  }
+  [[nodiscard]] std::FILE* handle() const {
+    return sink_.handle();
+  }
+
+  std::FILE* owned_{nullptr};
+  FileSink sink_;
+};
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_IO_JSON_LINES_HPP
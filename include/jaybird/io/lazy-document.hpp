@@ -0,0 +1,391 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_IO_LAZY_DOCUMENT_HPP
+#define INCLUDE_JAYBIRD_IO_LAZY_DOCUMENT_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/format.hpp"
+
+#include "jaybird/base/defs.hpp"
+#include "jaybird/io/file-contents.hpp"
+#include "jaybird/serialization/serialization.hpp"
+
+namespace jay {
+namespace detail {
+// A value in the structural index of a document, which lists the values in document order,
+// i.e. the values within a container follow it directly.
+struct LazyNode {
+  // The offsets of the value.
+  std::size_t begin;
+  std::size_t end;
+  // The offsets of the key (including the quotes) if the value is an object entry.
+  std::size_t key_begin;
+  std::size_t key_end;
+  // The index of the next value which is not contained in this one.
+  std::size_t next;
+};
+
+inline bool is_json_whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Builds the index in a single pass, which only checks the structure, i.e. brackets, commas,
+// colons, and the extents of strings. Values are only validated when they are decoded.
+inline std::vector<LazyNode> index_json(std::string_view text) {
+  std::vector<LazyNode> nodes{};
+  std::vector<std::size_t> open{};
+  std::size_t pos = 0;
+
+  auto error = [&](std::string_view msg) {
+    throw Json::parse_error::create(
+      101, pos + 1, fmt::format("syntax error while indexing value - {}", msg), nullptr);
+  };
+  auto skip_whitespace = [&] {
+    while (pos < text.size() && is_json_whitespace(text[pos])) {
+      ++pos;
+    }
+  };
+  auto skip_string = [&] {
+    ++pos;
+    while (true) {
+      pos = text.find_first_of("\"\\", pos);
+      if (pos == std::string_view::npos) {
+        pos = text.size();
+        error("unterminated string");
+      }
+      if (text[pos] == '"') {
+        ++pos;
+        return;
+      }
+      pos += 2;
+    }
+  };
+  auto close = [&] {
+    LazyNode& node = nodes[open.back()];
+    node.end = ++pos;
+    node.next = nodes.size();
+    open.pop_back();
+  };
+
+  while (true) {
+    skip_whitespace();
+    std::size_t key_begin = 0;
+    std::size_t key_end = 0;
+    if (!open.empty() && text[nodes[open.back()].begin] == '{') {
+      if (pos == text.size() || text[pos] != '"') {
+        error("expected a string as object key");
+      }
+      key_begin = pos;
+      skip_string();
+      key_end = pos;
+      skip_whitespace();
+      if (pos == text.size() || text[pos] != ':') {
+        error("expected ':'");
+      }
+      ++pos;
+      skip_whitespace();
+    }
+    if (pos == text.size()) {
+      error("unexpected end of input");
+    }
+
+    const std::size_t idx = nodes.size();
+    nodes.push_back({pos, pos, key_begin, key_end, idx + 1});
+    switch (text[pos]) {
+      case '{':
+      case '[': {
+        const char closing = text[pos] == '{' ? '}' : ']';
+        open.push_back(idx);
+        ++pos;
+        skip_whitespace();
+        if (pos < text.size() && text[pos] == closing) {
+          close();
+          break;
+        }
+        continue;
+      }
+      case '"': skip_string(); break;
+      default: {
+        const std::size_t end = text.find_first_of(",]} \t\n\r", pos);
+        pos = end == std::string_view::npos ? text.size() : end;
+        if (pos == nodes[idx].begin) {
+          error("expected a value");
+        }
+        break;
+      }
+    }
+    nodes[idx].end = std::max(nodes[idx].end, pos);
+
+    // Close the containers which end after the value and move to the next entry
+    while (true) {
+      skip_whitespace();
+      if (open.empty()) {
+        if (pos != text.size()) {
+          error("expected end of input");
+        }
+        return nodes;
+      }
+      if (pos == text.size()) {
+        error("unexpected end of input");
+      }
+      if (text[pos] == ',') {
+        ++pos;
+        break;
+      }
+      if (text[pos] != (text[nodes[open.back()].begin] == '{' ? '}' : ']')) {
+        error("expected ',' or the end of the container");
+      }
+      close();
+    }
+  }
+}
+} // namespace detail
+
+// A value within a `LazyDocument`, which is only decoded when requested.
+// It remains valid as long as the document exists, even if the document is moved.
+struct LazyValue {
+  LazyValue(std::string_view text, std::span<const detail::LazyNode> nodes, std::size_t idx)
+      : text_{text}, nodes_{nodes}, idx_{idx} {}
+
+  // The JSON text of the value.
+  [[nodiscard]] std::string_view text() const {
+    const detail::LazyNode& node = nodes_[idx_];
+    return text_.substr(node.begin, node.end - node.begin);
+  }
+
+  [[nodiscard]] bool is_object() const {
+    return first() == '{';
+  }
+  [[nodiscard]] bool is_array() const {
+    return first() == '[';
+  }
+  [[nodiscard]] bool is_string() const {
+    return first() == '"';
+  }
+
+  // The number of entries of an object or elements of an array, where duplicate keys are counted
+  // separately, and zero for all other values.
+  [[nodiscard]] std::size_t size() const {
+    std::size_t size = 0;
+    for_each_child([&](std::size_t /*child*/) {
+      ++size;
+      return true;
+    });
+    return size;
+  }
+
+  // As in `Json::parse`, the last entry with a given key is used.
+  [[nodiscard]] std::optional<LazyValue> find(std::string_view key) const {
+    std::optional<LazyValue> out{};
+    if (is_object()) {
+      for_each_child([&](std::size_t child) {
+        if (has_key(child, key)) {
+          out.emplace(text_, nodes_, child);
+        }
+        return true;
+      });
+    }
+    return out;
+  }
+  [[nodiscard]] LazyValue at(std::string_view key) const {
+    if (!is_object()) {
+      throw Json::type_error::create(304, fmt::format("cannot use at() with {}", type_name()),
+                                     nullptr);
+    }
+    if (auto value = find(key)) {
+      return *value;
+    }
+    throw Json::out_of_range::create(403, fmt::format("key '{}' not found", key), nullptr);
+  }
+  [[nodiscard]] LazyValue at(std::size_t index) const {
+    if (!is_array()) {
+      throw Json::type_error::create(304, fmt::format("cannot use at() with {}", type_name()),
+                                     nullptr);
+    }
+    std::optional<LazyValue> out{};
+    std::size_t i = 0;
+    for_each_child([&](std::size_t child) {
+      if (i++ == index) {
+        out.emplace(text_, nodes_, child);
+        return false;
+      }
+      return true;
+    });
+    if (!out.has_value()) {
+      throw Json::out_of_range::create(401, fmt::format("array index {} is out of range", index),
+                                       nullptr);
+    }
+    return *out;
+  }
+
+  // Resolves a JSON pointer (RFC 6901) relative to this value, with the errors of `Json::at`.
+  [[nodiscard]] LazyValue at_pointer(std::string_view pointer) const {
+    if (!pointer.empty() && pointer.front() != '/') {
+      throw Json::parse_error::create(
+        107, 1, fmt::format("JSON pointer must be empty or begin with '/' - was: '{}'", pointer),
+        nullptr);
+    }
+    LazyValue value = *this;
+    while (!pointer.empty()) {
+      pointer.remove_prefix(1);
+      const std::size_t end = std::min(pointer.find('/'), pointer.size());
+      const std::string token = unescape_token(pointer.substr(0, end));
+      pointer.remove_prefix(end);
+      if (value.is_object()) {
+        value = value.at(token);
+      } else if (value.is_array()) {
+        if (token == "-") {
+          throw Json::out_of_range::create(
+            402, fmt::format("array index '-' ({}) is out of range", value.size()), nullptr);
+        }
+        value = value.at(array_index(token));
+      } else {
+        throw Json::out_of_range::create(
+          404, fmt::format("unresolved reference token '{}'", token), nullptr);
+      }
+    }
+    return value;
+  }
+
+  // Decodes the value, which produces the same results and errors as parsing its text.
+  template<typename T>
+  [[nodiscard]] T get() const {
+    return parse<T>(text());
+  }
+  [[nodiscard]] Json dom() const {
+    return Json::parse(text());
+  }
+
+private:
+  [[nodiscard]] char first() const {
+    return text_[nodes_[idx_].begin];
+  }
+  [[nodiscard]] std::string_view type_name() const {
+    switch (first()) {
+      case '{': return "object";
+      case '[': return "array";
+      case '"': return "string";
+      case 'n': return "null";
+      case 't':
+      case 'f': return "boolean";
+      default: return "number";
+    }
+  }
+
+  // Calls `op` with the index of each child until it returns false.
+  template<typename TOp>
+  void for_each_child(TOp op) const {
+    if (!is_object() && !is_array()) {
+      return;
+    }
+    const std::size_t end = nodes_[idx_].next;
+    for (std::size_t child = idx_ + 1; child < end && op(child); child = nodes_[child].next) {
+    }
+  }
+
+  // Whether an object entry has the given key, where the key is compared in place
+  // and only unescaped if it contains escape sequences.
+  [[nodiscard]] bool has_key(std::size_t child, std::string_view key) const {
+    const detail::LazyNode& node = nodes_[child];
+    const std::string_view raw = text_.substr(node.key_begin, node.key_end - node.key_begin);
+    if (raw.find('\\') == std::string_view::npos) {
+      return raw.substr(1, raw.size() - 2) == key;
+    }
+    return Json::parse(raw).get_ref<const std::string&>() == key;
+  }
+
+  static std::string unescape_token(std::string_view token) {
+    std::string out{};
+    out.reserve(token.size());
+    for (std::size_t i = 0; i < token.size(); ++i) {
+      if (token[i] != '~') {
+        out.push_back(token[i]);
+        continue;
+      }
+      if (i + 1 == token.size() || (token[i + 1] != '0' && token[i + 1] != '1')) {
+        throw Json::parse_error::create(
+          108, 0, "escape character '~' must be followed with '0' or '1'", nullptr);
+      }
+      out.push_back(token[++i] == '0' ? '~' : '/');
+    }
+    return out;
+  }
+  // Parses an array index like `Json::json_pointer`, with the same errors.
+  static std::size_t array_index(const std::string& token) {
+    if (token.size() > 1 && token.front() == '0') {
+      throw Json::parse_error::create(
+        106, 0, fmt::format("array index '{}' must not begin with '0'", token), nullptr);
+    }
+    if (token.size() > 1 && (token.front() < '1' || token.front() > '9')) {
+      throw Json::parse_error::create(
+        109, 0, fmt::format("array index '{}' is not a number", token), nullptr);
+    }
+    std::size_t index = 0;
+    const char* end = token.data() + token.size();
+    if (const auto [ptr, ec] = std::from_chars(token.data(), end, index);
+        token.empty() || ec != std::errc{} || ptr != end) {
+      throw Json::out_of_range::create(
+        404, fmt::format("unresolved reference token '{}'", token), nullptr);
+    }
+    return index;
+  }
+
+  std::string_view text_;
+  std::span<const detail::LazyNode> nodes_;
+  std::size_t idx_;
+};
+
+// A JSON document which is only indexed when loaded, where values are decoded on access.
+// Files are memory-mapped where possible, so that only the parts which are accessed and
+// the structural index need to be in memory.
+struct LazyDocument {
+  // The text needs to outlive the document.
+  explicit LazyDocument(std::string_view text)
+      : text_{text}, nodes_{detail::index_json(text_)} {}
+  // Only accepts paths so that strings are always treated as JSON text.
+  template<std::same_as<std::filesystem::path> TPath>
+  explicit LazyDocument(const TPath& path)
+      : contents_{std::make_unique<FileContents>(path)}, text_{contents_->view()},
+        nodes_{detail::index_json(text_)} {}
+
+  [[nodiscard]] LazyValue root() const {
+    return LazyValue{text_, nodes_, 0};
+  }
+  [[nodiscard]] LazyValue at(std::string_view pointer) const {
+    return root().at_pointer(pointer);
+  }
+  template<typename T>
+  [[nodiscard]] T get(std::string_view pointer = {}) const {
+    return at(pointer).get<T>();
+  }
+
+  // The number of values in the structural index.
+  [[nodiscard]] std::size_t value_num() const {
+    return nodes_.size();
+  }
+
+private:
+  std::unique_ptr<FileContents> contents_{};
+  std::string_view text_;
+  std::vector<detail::LazyNode> nodes_;
+};
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_IO_LAZY_DOCUMENT_HPP
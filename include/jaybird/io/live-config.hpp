@@ -0,0 +1,352 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_IO_LIVE_CONFIG_HPP
+#define INCLUDE_JAYBIRD_IO_LIVE_CONFIG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#if __has_include(<sys/inotify.h>)
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define JAYBIRD_HAS_INOTIFY 1
+#else
+#define JAYBIRD_HAS_INOTIFY 0
+#endif
+
+#include "jaybird/base/defs.hpp"
+#include "jaybird/io/io.hpp"
+#include "jaybird/serialization/codec.hpp"
+#include "jaybird/serialization/serialization.hpp"
+
+namespace jay {
+namespace detail {
+// Waits for a file to be written or replaced, which is detected using inotify on its directory
+// where available, so that files replaced by renaming (e.g. by `write_file`) are noticed.
+struct FileWatcher {
+  explicit FileWatcher(const std::filesystem::path& path) {
+#if JAYBIRD_HAS_INOTIFY
+    wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0) {
+      throw std::system_error{errno, std::generic_category(), "Creating an eventfd failed"};
+    }
+    // Without inotify (e.g. if the limit of instances is reached), only polling is used
+    inotify_fd_ = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotify_fd_ >= 0) {
+      const std::filesystem::path dir = path.parent_path().empty() ? "." : path.parent_path();
+      if (::inotify_add_watch(inotify_fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        ::close(inotify_fd_);
+        inotify_fd_ = -1;
+      }
+    }
+    name_ = path.filename().string();
+#else
+    static_cast<void>(path);
+#endif
+  }
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher(FileWatcher&&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+  FileWatcher& operator=(FileWatcher&&) = delete;
+  ~FileWatcher() {
+#if JAYBIRD_HAS_INOTIFY
+    if (inotify_fd_ >= 0) {
+      ::close(inotify_fd_);
+    }
+    ::close(wake_fd_);
+#endif
+  }
+
+  // Waits until the file has been written or replaced, `timeout` has passed, or `wake` has been
+  // called, and returns whether the file has been written or replaced.
+  bool wait(std::chrono::milliseconds timeout) {
+#if JAYBIRD_HAS_INOTIFY
+    std::array<::pollfd, 2> fds{{{wake_fd_, POLLIN, 0}, {inotify_fd_, POLLIN, 0}}};
+    const ::nfds_t fd_num = inotify_fd_ >= 0 ? 2 : 1;
+    if (::poll(fds.data(), fd_num, static_cast<int>(timeout.count())) <= 0) {
+      return false;
+    }
+    if ((fds[0].revents & POLLIN) != 0) {
+      std::uint64_t count{};
+      [[maybe_unused]] const ::ssize_t size = ::read(wake_fd_, &count, sizeof(count));
+      return false;
+    }
+    return (fds[1].revents & POLLIN) != 0 && read_events();
+#else
+    std::unique_lock lock{mutex_};
+    condition_.wait_for(lock, timeout, [&] { return woken_; });
+    woken_ = false;
+    return false;
+#endif
+  }
+
+  void wake() {
+#if JAYBIRD_HAS_INOTIFY
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ::ssize_t size = ::write(wake_fd_, &one, sizeof(one));
+#else
+    {
+      const std::lock_guard lock{mutex_};
+      woken_ = true;
+    }
+    condition_.notify_one();
+#endif
+  }
+
+private:
+#if JAYBIRD_HAS_INOTIFY
+  // Consumes the pending events and returns whether one of them concerns the file.
+  bool read_events() {
+    bool changed = false;
+    alignas(::inotify_event) std::array<char, 4096> buffer{};
+    for (;;) {
+      const ::ssize_t size = ::read(inotify_fd_, buffer.data(), buffer.size());
+      if (size <= 0) {
+        return changed;
+      }
+      for (std::size_t offset = 0; offset < static_cast<std::size_t>(size);) {
+        ::inotify_event event{};
+        std::memcpy(&event, buffer.data() + offset, sizeof(event));
+        const char* name = buffer.data() + offset + sizeof(event);
+        if (event.len > 0 && name_ == name) {
+          changed = true;
+        }
+        offset += sizeof(event) + event.len;
+      }
+    }
+  }
+
+  int wake_fd_{-1};
+  int inotify_fd_{-1};
+  std::string name_{};
+#else
+  std::mutex mutex_{};
+  std::condition_variable condition_{};
+  bool woken_{false};
+#endif
+};
+
+// The modification time and size of a file, which are compared to detect changes which
+// are not reported by the watcher.
+struct FileStamp {
+  std::filesystem::file_time_type time{};
+  std::uintmax_t size{0};
+
+  static std::optional<FileStamp> of(const std::filesystem::path& path) {
+    std::error_code ec{};
+    const auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+      return std::nullopt;
+    }
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+      return std::nullopt;
+    }
+    return FileStamp{time, size};
+  }
+
+  bool operator==(const FileStamp&) const = default;
+};
+} // namespace detail
+
+struct LiveConfigOptions {
+  Format format = Format::json;
+  // The interval in which the modification time and size of the file are compared,
+  // which detects changes where inotify is not available or does not report them.
+  std::chrono::milliseconds poll_interval{1000};
+};
+
+// The error thrown when a configuration cannot be decoded, which keeps the JSON pointer
+// to the value which could not be decoded.
+struct ConfigDecodeError : std::runtime_error {
+  explicit ConfigDecodeError(const DecodeError& error)
+      : std::runtime_error{error.what()}, pointer_{error.pointer()} {}
+
+  [[nodiscard]] const std::string& pointer() const noexcept {
+    return pointer_;
+  }
+
+private:
+  std::string pointer_;
+};
+
+// A reload which failed, after which the previous snapshot is kept.
+struct ReloadError {
+  std::filesystem::path path;
+  std::string message;
+  // The pointer to the value which could not be decoded, which is empty for other errors.
+  std::string pointer{};
+};
+using ReloadErrorHandler = std::function<void(const ReloadError&)>;
+
+// A configuration file which is decoded into an immutable snapshot of a `T` and reloaded
+// by a background thread whenever it changes, where a new snapshot is only published if
+// the file passes `static_check` and can be decoded.
+// Snapshots are published atomically, i.e. a snapshot which has been obtained remains valid
+// and unchanged, and all snapshots obtained after a reload are the new one.
+template<typename T>
+struct LiveConfig {
+  using Snapshot = std::shared_ptr<const T>;
+
+  // A handle for a single thread which keeps the current snapshot, so that accessing it
+  // is wait-free and only requires an atomic load of the version unless there has been
+  // a reload since the last access.
+  struct Reader {
+    explicit Reader(const LiveConfig& config) : config_{&config} {}
+
+    // The returned reference is valid until the next access through this reader.
+    const T& operator*() {
+      return *snapshot();
+    }
+    const T* operator->() {
+      return snapshot().get();
+    }
+    const Snapshot& snapshot() {
+      if (const auto version = config_->version(); version != version_) {
+        snapshot_ = config_->snapshot();
+        version_ = version;
+      }
+      return snapshot_;
+    }
+
+  private:
+    const LiveConfig* config_;
+    std::uint64_t version_{0};
+    Snapshot snapshot_{};
+  };
+
+  // Loads the file, throwing the error of `read_file` or `static_check` or a
+  // `ConfigDecodeError` if it is not valid, and starts watching it.
+  explicit LiveConfig(std::filesystem::path path, LiveConfigOptions options = {},
+                      ReloadErrorHandler on_error = {})
+      : path_{std::move(path)}, options_{options}, on_error_{std::move(on_error)},
+        stamp_{detail::FileStamp::of(path_)}, watcher_{path_} {
+    publish(load());
+    thread_ = std::jthread{[this](const std::stop_token& stop) { watch(stop); }};
+  }
+  LiveConfig(const LiveConfig&) = delete;
+  LiveConfig(LiveConfig&&) = delete;
+  LiveConfig& operator=(const LiveConfig&) = delete;
+  LiveConfig& operator=(LiveConfig&&) = delete;
+  ~LiveConfig() = default;
+
+  [[nodiscard]] Snapshot snapshot() const {
+    return current_.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] Reader reader() const {
+    return Reader{*this};
+  }
+  // The number of snapshots which have been published, starting at one.
+  [[nodiscard]] std::uint64_t version() const {
+    return version_.load(std::memory_order_acquire);
+  }
+
+  // Reloads the file immediately, returning whether a new snapshot has been published.
+  bool reload() {
+    const std::lock_guard lock{reload_mutex_};
+    return reload_locked();
+  }
+
+  // The error of the last reload if it failed.
+  [[nodiscard]] std::optional<ReloadError> last_error() const {
+    const std::lock_guard lock{error_mutex_};
+    return last_error_;
+  }
+
+private:
+  Snapshot load() const {
+    const Json json = read_file(path_, options_.format);
+    // Without a check of its own, `static_check` would decode the value an additional time
+    if constexpr (requires { JsonConverter<T>::static_check(json); }) {
+      if (auto error = JsonConverter<T>::static_check(json)) {
+        throw error->exception();
+      }
+    }
+    auto value = try_from_json<T>(json);
+    if (!value.has_value()) {
+      throw ConfigDecodeError{value.error()};
+    }
+    return std::make_shared<const T>(std::move(*value));
+  }
+  void publish(Snapshot snapshot) {
+    current_.store(std::move(snapshot), std::memory_order_release);
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  bool reload_locked() {
+    // The stamp is taken first so that changes during the reload are noticed
+    stamp_ = detail::FileStamp::of(path_);
+    try {
+      publish(load());
+      const std::lock_guard lock{error_mutex_};
+      last_error_.reset();
+      return true;
+    } catch (const ConfigDecodeError& ex) {
+      report(ReloadError{path_, ex.what(), ex.pointer()});
+    } catch (const std::exception& ex) {
+      report(ReloadError{path_, ex.what()});
+    }
+    return false;
+  }
+  void report(ReloadError error) {
+    if (on_error_) {
+      on_error_(error);
+    }
+    const std::lock_guard lock{error_mutex_};
+    last_error_ = std::move(error);
+  }
+
+  void watch(const std::stop_token& stop) {
+    const std::stop_callback wake{stop, [this] { watcher_.wake(); }};
+    while (!stop.stop_requested()) {
+      const bool changed = watcher_.wait(options_.poll_interval);
+      if (stop.stop_requested()) {
+        return;
+      }
+      const std::lock_guard lock{reload_mutex_};
+      if (changed || detail::FileStamp::of(path_) != stamp_) {
+        reload_locked();
+      }
+    }
+  }
+
+  std::filesystem::path path_;
+  LiveConfigOptions options_;
+  ReloadErrorHandler on_error_;
+  std::atomic<Snapshot> current_{};
+  std::atomic<std::uint64_t> version_{0};
+  std::mutex reload_mutex_{};
+  std::optional<detail::FileStamp> stamp_;
+  mutable std::mutex error_mutex_{};
+  std::optional<ReloadError> last_error_{};
+  detail::FileWatcher watcher_;
+  // Declared last so that the thread is stopped before the other members are destroyed
+  std::jthread thread_{};
+};
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_IO_LIVE_CONFIG_HPP
@@ -0,0 +1,257 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_IO_PARALLEL_READ_HPP
+#define INCLUDE_JAYBIRD_IO_PARALLEL_READ_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "jaybird/base/parallel.hpp"
+#include "jaybird/io/file-contents.hpp"
+#include "jaybird/serialization/serialization.hpp"
+
+namespace jay {
+namespace detail {
+inline constexpr std::string_view json_whitespace = " \t\n\r";
+
+inline std::string_view trim_json(std::string_view text) {
+  const std::size_t begin = text.find_first_not_of(json_whitespace);
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+  return text.substr(begin, text.find_last_not_of(json_whitespace) + 1 - begin);
+}
+
+// Whether the character at `pos` is escaped, i.e. preceded by an odd number of backslashes.
+// Since backslashes only occur in strings, this does not depend on the string state.
+inline bool is_escaped(std::string_view text, std::size_t pos) {
+  std::size_t num = 0;
+  while (num < pos && text[pos - num - 1] == '\\') {
+    ++num;
+  }
+  return num % 2 == 1;
+}
+
+// The effect of a part of JSON text on the structural state for both possible string states
+// at its beginning, which are told apart by the same quotes.
+struct SegmentSummary {
+  bool toggles_string = false;
+  std::ptrdiff_t outside_delta = 0;
+  std::ptrdiff_t inside_delta = 0;
+};
+
+inline SegmentSummary summarize_segment(std::string_view text, std::size_t begin,
+                                        std::size_t end) {
+  SegmentSummary out{};
+  bool escaped = is_escaped(text, begin);
+  for (std::size_t i = begin; i < end; ++i) {
+    if (escaped) {
+      escaped = false;
+      continue;
+    }
+    switch (text[i]) {
+      case '\\': escaped = true; break;
+      case '"': out.toggles_string = !out.toggles_string; break;
+      case '[':
+      case '{': ++(out.toggles_string ? out.inside_delta : out.outside_delta); break;
+      case ']':
+      case '}': --(out.toggles_string ? out.inside_delta : out.outside_delta); break;
+      default: break;
+    }
+  }
+  return out;
+}
+
+// Returns the position of the next comma outside of strings at depth 1 or of the bracket which
+// closes depth 1, starting at `pos` in the given state, or `end` if there is none.
+inline std::size_t find_separator(std::string_view text, std::size_t pos, std::size_t end,
+                                  bool in_string, std::ptrdiff_t depth) {
+  bool escaped = is_escaped(text, pos);
+  for (std::size_t i = pos; i < end; ++i) {
+    if (escaped) {
+      escaped = false;
+      continue;
+    }
+    const char c = text[i];
+    if (c == '\\') {
+      escaped = true;
+    } else if (c == '"') {
+      in_string = !in_string;
+    } else if (in_string) {
+      continue;
+    } else if (c == '[' || c == '{') {
+      ++depth;
+    } else if (c == ']' || c == '}') {
+      if (--depth == 0) {
+        return i;
+      }
+    } else if (c == ',' && depth == 1) {
+      return i;
+    }
+  }
+  return end;
+}
+
+// Splits the elements of a top-level array (without its brackets) into chunks of roughly
+// `chunk_size` bytes at element boundaries.
+// The string state and nesting depth at the beginning of each of these segments are found
+// by summarizing all segments in parallel, so that no sequential scan of the text is needed.
+inline std::vector<std::string_view> split_array(std::string_view text,
+                                                 const ParallelOptions& options) {
+  const std::size_t seg_num = std::max<std::size_t>(text.size() / options.chunk_size, 1);
+  auto seg_begin = [&](std::size_t k) { return k * text.size() / seg_num; };
+
+  std::vector<SegmentSummary> summaries(seg_num);
+  parallel_for(options.effective_thread_num(), seg_num, [&](std::size_t k) {
+    summaries[k] = summarize_segment(text, seg_begin(k), seg_begin(k + 1));
+  });
+
+  std::vector<std::size_t> cuts(seg_num + 1, 0);
+  cuts[seg_num] = text.size();
+  std::vector<std::pair<bool, std::ptrdiff_t>> states(seg_num, {false, 1});
+  for (std::size_t k = 1; k < seg_num; ++k) {
+    const auto [in_string, depth] = states[k - 1];
+    const SegmentSummary& summary = summaries[k - 1];
+    states[k] = {in_string != summary.toggles_string,
+                 depth + (in_string ? summary.inside_delta : summary.outside_delta)};
+  }
+  parallel_for(options.effective_thread_num(), seg_num - 1, [&](std::size_t k) {
+    const auto [in_string, depth] = states[k + 1];
+    const std::size_t sep =
+      find_separator(text, seg_begin(k + 1), text.size(), in_string, depth);
+    cuts[k + 1] = std::min(sep + 1, text.size());
+  });
+
+  std::vector<std::string_view> chunks{};
+  for (std::size_t k = 0; k < seg_num; ++k) {
+    if (cuts[k] < cuts[k + 1]) {
+      chunks.push_back(text.substr(cuts[k], cuts[k + 1] - cuts[k]));
+    }
+  }
+  return chunks;
+}
+
+// Splits JSON Lines into chunks of roughly `chunk_size` bytes at line boundaries.
+inline std::vector<std::string_view> split_lines(std::string_view text,
+                                                 const ParallelOptions& options) {
+  std::vector<std::string_view> chunks{};
+  for (std::size_t begin = 0; begin < text.size();) {
+    const std::size_t newline = text.find('\n', std::min(begin + options.chunk_size, text.size()));
+    const std::size_t end = newline == std::string_view::npos ? text.size() : newline + 1;
+    chunks.push_back(text.substr(begin, end - begin));
+    begin = end;
+  }
+  return chunks;
+}
+
+// Throws the error of the DOM-based path for text which is not an array.
+template<typename T>
+[[noreturn]] inline void throw_array_error(std::string_view text) {
+  const Json json = Json::parse(text);
+  from_json<std::vector<T>>(json);
+  throw std::invalid_argument{"The records are not a top-level array!"};
+}
+
+template<typename T>
+inline std::vector<T> decode_array_chunk(std::string_view chunk) {
+  std::vector<T> records{};
+  for (std::size_t pos = 0; pos < chunk.size();) {
+    const std::size_t sep = find_separator(chunk, pos, chunk.size(), false, 1);
+    records.push_back(parse<T>(trim_json(chunk.substr(pos, sep - pos))));
+    pos = sep + 1;
+  }
+  return records;
+}
+
+template<typename T>
+inline std::vector<T> decode_line_chunk(std::string_view chunk) {
+  std::vector<T> records{};
+  for (std::size_t pos = 0; pos < chunk.size();) {
+    const std::size_t newline = chunk.find('\n', pos);
+    const std::size_t end = newline == std::string_view::npos ? chunk.size() : newline;
+    if (const std::string_view line = trim_json(chunk.substr(pos, end - pos)); !line.empty()) {
+      records.push_back(parse<T>(line));
+    }
+    pos = end + 1;
+  }
+  return records;
+}
+
+// Decodes the chunks on worker threads and passes the records to `op` on the calling thread.
+template<typename T, typename TDecode, typename TOp>
+inline void decode_chunks(const std::vector<std::string_view>& chunks, TDecode decode, TOp& op,
+                          const ParallelOptions& options) {
+  parallel_pipeline(
+    chunks.size(), [&](std::size_t i) { return decode(chunks[i]); },
+    [&](std::vector<T>&& records) {
+      for (T& record : records) {
+        op(std::move(record));
+      }
+    },
+    options);
+}
+} // namespace detail
+
+// Decodes the records of JSON Lines or of a top-level array in parallel, where `op` is called
+// with each record (as an rvalue) on the calling thread, either in the original order or as
+// the records are decoded, depending on `options.ordered`.
+// The text is split into chunks of about `options.chunk_size` bytes at record boundaries,
+// which are decoded using `parse<T>` on `options.thread_num` worker threads.
+// Empty lines are ignored, and the first error (in the order of the chunks if `ordered`
+// is set) is rethrown on the calling thread.
+template<typename T, typename TOp>
+inline void parse_records(std::string_view text, TOp op, const ParallelOptions& options = {},
+                          RecordLayout layout = RecordLayout::detect) {
+  const std::string_view trimmed = detail::trim_json(text);
+  if (layout == RecordLayout::detect) {
+    layout = trimmed.starts_with('[') ? RecordLayout::array : RecordLayout::json_lines;
+  }
+
+  if (layout == RecordLayout::json_lines) {
+    detail::decode_chunks<T>(detail::split_lines(text, options), &detail::decode_line_chunk<T>,
+                             op, options);
+    return;
+  }
+
+  if (trimmed.size() < 2 || !trimmed.starts_with('[') || !trimmed.ends_with(']')) {
+    detail::throw_array_error<T>(text);
+  }
+  const std::string_view elements = trimmed.substr(1, trimmed.size() - 2);
+  if (const std::string_view inner = detail::trim_json(elements); inner.empty()) {
+    return;
+  } else if (inner.ends_with(',')) {
+    detail::throw_array_error<T>(text);
+  }
+  detail::decode_chunks<T>(detail::split_array(elements, options),
+                           &detail::decode_array_chunk<T>, op, options);
+}
+
+// Decodes the records of a file (see `parse_records`), which is memory-mapped if possible.
+template<typename T, typename TOp>
+inline void read_records(const std::filesystem::path& p, TOp op,
+                         const ParallelOptions& options = {},
+                         RecordLayout layout = RecordLayout::detect) {
+  const FileContents contents{p};
+  parse_records<T>(contents.view(), std::move(op), options, layout);
+}
+// Decodes all records of a file in their original order.
+template<typename T>
+inline std::vector<T> read_records(const std::filesystem::path& p, ParallelOptions options = {},
+                                   RecordLayout layout = RecordLayout::detect) {
+  options.ordered = true;
+  std::vector<T> out{};
+  read_records<T>(p, [&](T&& record) { out.push_back(std::move(record)); }, options, layout);
+  return out;
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_IO_PARALLEL_READ_HPP
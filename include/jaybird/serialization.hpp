@@ -2,7 +2,17 @@
 #define INCLUDE_JAYBIRD_SERIALIZATION_HPP
 
 // IWYU pragma: begin_exports
+#include "serialization/binary.hpp"
+#include "serialization/cbor.hpp"
+#include "serialization/codec.hpp"
+#include "serialization/dom.hpp"
+#include "serialization/floating.hpp"
+#include "serialization/msgpack.hpp"
+#include "serialization/parallel-write.hpp"
+#include "serialization/patch.hpp"
+#include "serialization/reader.hpp"
 #include "serialization/serialization.hpp"
+#include "serialization/writer.hpp"
 // IWYU pragma: end_exports
 
 #endif // INCLUDE_JAYBIRD_SERIALIZATION_HPP
@@ -0,0 +1,162 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_BINARY_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_BINARY_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/format.hpp"
+
+#include "jaybird/base/defs.hpp"
+
+// Building blocks shared by the binary formats (CBOR and MessagePack), which store numbers
+// in big-endian byte order and containers with their sizes.
+namespace jay {
+namespace detail {
+template<typename T, typename TSink>
+inline void write_big_endian(TSink& sink, T value) {
+  auto bytes = std::bit_cast<std::array<char, sizeof(T)>>(value);
+  if constexpr (std::endian::native == std::endian::little) {
+    for (std::size_t i = 0; i < sizeof(T) / 2; ++i) {
+      std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+    }
+  }
+  sink.write({bytes.data(), bytes.size()});
+}
+
+// Whether a finite value can be stored as a single-precision float without changing it,
+// as decided by `Json::to_cbor` and `Json::to_msgpack`.
+inline bool is_compact_float(Real value) {
+  return value >= static_cast<Real>(std::numeric_limits<float>::lowest()) &&
+         value <= static_cast<Real>(std::numeric_limits<float>::max()) &&
+         static_cast<Real>(static_cast<float>(value)) == value;
+}
+
+// The bytes of a binary document together with the read position.
+struct ByteInput {
+  explicit ByteInput(std::string_view bytes) : bytes_{bytes} {}
+
+  [[nodiscard]] bool at_end() const {
+    return pos_ == bytes_.size();
+  }
+  [[nodiscard]] std::size_t position() const {
+    return pos_;
+  }
+
+  [[nodiscard]] std::uint8_t peek() const {
+    if (at_end()) {
+      end_error();
+    }
+    return static_cast<std::uint8_t>(bytes_[pos_]);
+  }
+  std::uint8_t get() {
+    const std::uint8_t byte = peek();
+    ++pos_;
+    return byte;
+  }
+  std::string_view take(std::size_t size) {
+    if (size > bytes_.size() - pos_) {
+      end_error();
+    }
+    const std::string_view out = bytes_.substr(pos_, size);
+    pos_ += size;
+    return out;
+  }
+  template<typename T>
+  T big_endian() {
+    const std::string_view raw = take(sizeof(T));
+    std::array<char, sizeof(T)> bytes{};
+    std::copy(raw.begin(), raw.end(), bytes.begin());
+    if constexpr (std::endian::native == std::endian::little) {
+      std::reverse(bytes.begin(), bytes.end());
+    }
+    return std::bit_cast<T>(bytes);
+  }
+
+  [[noreturn]] void error(std::string_view format, std::string_view msg) const {
+    throw Json::parse_error::create(
+      110, pos_, fmt::format("syntax error while parsing {} value - {}", format, msg), nullptr);
+  }
+
+private:
+  [[noreturn]] void end_error() const {
+    throw Json::parse_error::create(110, pos_, "unexpected end of input", nullptr);
+  }
+
+  std::string_view bytes_;
+  std::size_t pos_{0};
+};
+
+// The number of remaining entries in each open container, where containers of indefinite
+// length are terminated by a break marker instead.
+struct ContainerStack {
+  static constexpr std::size_t indefinite = std::numeric_limits<std::size_t>::max();
+
+  void push(std::size_t size, bool is_object) {
+    containers_.push_back({size, is_object});
+  }
+  // Whether the innermost container has another entry, given whether the next byte would
+  // terminate an indefinite container; the container is closed if not.
+  bool next(bool at_break) {
+    std::size_t& remaining = containers_.back().remaining;
+    if (remaining == indefinite ? at_break : remaining == 0) {
+      containers_.pop_back();
+      return false;
+    }
+    if (remaining != indefinite) {
+      --remaining;
+    }
+    return true;
+  }
+  [[nodiscard]] bool is_indefinite() const {
+    return containers_.back().remaining == indefinite;
+  }
+  [[nodiscard]] bool is_object() const {
+    return containers_.back().is_object;
+  }
+  [[nodiscard]] std::size_t depth() const {
+    return containers_.size();
+  }
+
+private:
+  struct Container {
+    std::size_t remaining;
+    bool is_object;
+  };
+
+  std::vector<Container> containers_{};
+};
+
+// Appends bytes to a byte vector, which is the result type of `Json::to_cbor`.
+struct ByteVectorSink {
+  explicit ByteVectorSink(std::vector<std::uint8_t>& bytes) : bytes_{bytes} {}
+
+  void put(char c) {
+    bytes_.push_back(static_cast<std::uint8_t>(c));
+  }
+  void write(std::string_view str) {
+    bytes_.insert(bytes_.end(), str.begin(), str.end());
+  }
+
+private:
+  std::vector<std::uint8_t>& bytes_;
+};
+} // namespace detail
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_BINARY_HPP
@@ -0,0 +1,472 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_CBOR_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_CBOR_HPP
+
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/format.hpp"
+
+#include "jaybird/base/defs.hpp"
+#include "jaybird/serialization/binary.hpp"
+#include "jaybird/serialization/serialization.hpp"
+#include "jaybird/serialization/writer.hpp"
+
+namespace jay {
+// Emits CBOR (RFC 8949) with the same encoding as `Json::to_cbor`, i.e. using the shortest
+// heads, single-precision floats where they are exact, and definite lengths.
+template<JsonSink TSink>
+struct CborWriter {
+  explicit CborWriter(TSink& sink) : sink_{sink} {}
+
+  void null() {
+    byte(0xF6);
+  }
+  void boolean(bool value) {
+    byte(value ? 0xF5 : 0xF4);
+  }
+  void integer(Int value) {
+    if (value >= 0) {
+      head(0, static_cast<UInt>(value));
+    } else {
+      head(1, static_cast<UInt>(-1 - value));
+    }
+  }
+  void unsigned_integer(UInt value) {
+    head(0, value);
+  }
+  void floating(Real value) {
+    if (std::isnan(value)) {
+      sink_.write({"\xF9\x7E\x00", 3});
+    } else if (std::isinf(value)) {
+      sink_.write(value > 0 ? std::string_view{"\xF9\x7C\x00", 3}
+                            : std::string_view{"\xF9\xFC\x00", 3});
+    } else if (detail::is_compact_float(value)) {
+      byte(0xFA);
+      detail::write_big_endian(sink_, static_cast<float>(value));
+    } else {
+      byte(0xFB);
+      detail::write_big_endian(sink_, value);
+    }
+  }
+  // A finite `float` is always written in single precision, whereas the double in the DOM
+  // produced by `to_json` is only written in single precision if it is exact.
+  void floating32(float value) {
+    if (!std::isfinite(value)) {
+      floating(static_cast<Real>(value));
+      return;
+    }
+    byte(0xFA);
+    detail::write_big_endian(sink_, value);
+  }
+  void string(std::string_view str) {
+    head(3, str.size());
+    sink_.write(str);
+  }
+
+  void begin_object(std::size_t size) {
+    head(5, size);
+  }
+  void key(std::string_view key) {
+    string(key);
+  }
+  void end_object() {}
+
+  void begin_array(std::size_t size) {
+    head(4, size);
+  }
+  void element() {}
+  void end_array() {}
+
+private:
+  void byte(unsigned value) {
+    sink_.put(static_cast<char>(value));
+  }
+  void head(unsigned major, UInt argument) {
+    const unsigned prefix = major << 5U;
+    if (argument <= 0x17) {
+      byte(prefix | static_cast<unsigned>(argument));
+    } else if (argument <= std::numeric_limits<std::uint8_t>::max()) {
+      byte(prefix | 24U);
+      byte(static_cast<unsigned>(argument));
+    } else if (argument <= std::numeric_limits<std::uint16_t>::max()) {
+      byte(prefix | 25U);
+      detail::write_big_endian(sink_, static_cast<std::uint16_t>(argument));
+    } else if (argument <= std::numeric_limits<std::uint32_t>::max()) {
+      byte(prefix | 26U);
+      detail::write_big_endian(sink_, static_cast<std::uint32_t>(argument));
+    } else {
+      byte(prefix | 27U);
+      detail::write_big_endian(sink_, argument);
+    }
+  }
+
+  TSink& sink_;
+};
+
+// A pull parser for CBOR with the interface of `JsonReader`, which accepts the subset of CBOR
+// supported by `Json::from_cbor` (with tags rejected), including indefinite lengths.
+struct CborReader {
+  explicit CborReader(std::string_view bytes, std::size_t max_depth = default_max_depth)
+      : input_{bytes}, max_depth_{max_depth} {}
+
+  [[nodiscard]] bool is_null() const {
+    return !input_.at_end() && input_.peek() == 0xF6;
+  }
+
+  void null() {
+    if (input_.peek() != 0xF6) {
+      type_error("null");
+    }
+    input_.get();
+  }
+  bool boolean() {
+    const std::uint8_t byte = input_.peek();
+    if (byte != 0xF4 && byte != 0xF5) {
+      type_error("boolean");
+    }
+    input_.get();
+    return byte == 0xF5;
+  }
+  template<typename T>
+  T number() {
+    auto convert = []<typename TValue>(TValue value) -> T {
+      if constexpr (std::same_as<TValue, T>) {
+        return value;
+      } else {
+        return static_cast<T>(value);
+      }
+    };
+    const std::uint8_t byte = input_.peek();
+    switch (byte >> 5U) {
+      case 0: input_.get(); return convert(argument(byte));
+      case 1: input_.get(); return convert(negative(argument(byte)));
+      case 7:
+        if (byte >= 0xF9 && byte <= 0xFB) {
+          return convert(floating());
+        }
+        break;
+      default: break;
+    }
+    type_error("number");
+  }
+  // The returned view is valid until the next member function call.
+  std::string_view string_view() {
+    const std::uint8_t byte = input_.peek();
+    if (byte >> 5U != 3) {
+      type_error("string");
+    }
+    return chunks(3);
+  }
+  std::string string() {
+    return std::string{string_view()};
+  }
+
+  void begin_object() {
+    begin_container(5, "object");
+  }
+  // The returned key is valid until the next member function call.
+  std::optional<std::string_view> key() {
+    if (!next_entry()) {
+      return std::nullopt;
+    }
+    if (input_.peek() >> 5U != 3) {
+      input_.error("CBOR", "expected a string as object key");
+    }
+    const std::string_view out = chunks(3);
+    value_start_ = input_.position();
+    return out;
+  }
+
+  void begin_array() {
+    begin_container(4, "array");
+  }
+  bool element() {
+    if (!next_entry()) {
+      return false;
+    }
+    value_start_ = input_.position();
+    return true;
+  }
+
+  // Reads the next value into a DOM, e.g. for types without a streaming implementation.
+  Json dom() {
+    const std::uint8_t byte = input_.peek();
+    switch (byte >> 5U) {
+      case 0: input_.get(); return argument(byte);
+      case 1: input_.get(); return negative(argument(byte));
+      case 2: {
+        const std::string_view bytes = chunks(2);
+        return Json::binary(std::vector<std::uint8_t>(bytes.begin(), bytes.end()));
+      }
+      case 3: return string();
+      case 4: {
+        auto out = Json::array();
+        begin_array();
+        while (element()) {
+          out.push_back(dom());
+        }
+        return out;
+      }
+      case 5: {
+        auto out = Json::object();
+        begin_object();
+        while (const auto k = key()) {
+          Json& slot = out[std::string{*k}];
+          slot = dom();
+        }
+        return out;
+      }
+      default: break;
+    }
+    switch (byte) {
+      case 0xF4: input_.get(); return false;
+      case 0xF5: input_.get(); return true;
+      case 0xF6: input_.get(); return nullptr;
+      case 0xF9:
+      case 0xFA:
+      case 0xFB: return floating();
+      default: invalid_byte(byte);
+    }
+  }
+
+  // Skips the next value, validating it like `dom` would.
+  void skip() {
+    const std::uint8_t byte = input_.peek();
+    switch (byte >> 5U) {
+      case 0:
+      case 1: input_.get(); argument(byte); break;
+      case 2:
+      case 3: chunks(byte >> 5U); break;
+      case 4: {
+        begin_array();
+        while (element()) {
+          skip();
+        }
+        break;
+      }
+      case 5: {
+        begin_object();
+        while (key().has_value()) {
+          skip();
+        }
+        break;
+      }
+      default: dom(); break;
+    }
+  }
+
+  // The number of arrays and maps which are currently open.
+  [[nodiscard]] std::size_t depth() const {
+    return stack_.depth();
+  }
+  // Skips the rest of a value which could not be decoded until only `depth` arrays and maps
+  // are open, validating it like `skip`, so that reading can continue after the value.
+  void recover(std::size_t depth) {
+    if (input_.position() == value_start_) {
+      skip();
+    }
+    while (stack_.depth() > depth) {
+      if (stack_.is_object()) {
+        while (key().has_value()) {
+          skip();
+        }
+      } else {
+        while (element()) {
+          skip();
+        }
+      }
+    }
+  }
+
+  // Ensures that the input contains nothing after the last value.
+  void finish() const {
+    if (!input_.at_end()) {
+      input_.error("CBOR", "expected end of input");
+    }
+  }
+
+  [[nodiscard]] std::size_t position() const {
+    return input_.position();
+  }
+
+private:
+  // Reads the argument of the head `byte`, which has already been consumed.
+  UInt argument(std::uint8_t byte) {
+    const unsigned info = byte & 0x1FU;
+    switch (info) {
+      case 24: return input_.get();
+      case 25: return input_.big_endian<std::uint16_t>();
+      case 26: return input_.big_endian<std::uint32_t>();
+      case 27: return input_.big_endian<std::uint64_t>();
+      default:
+        if (info < 24) {
+          return info;
+        }
+        invalid_byte(byte);
+    }
+  }
+  static Int negative(UInt argument) {
+    return Int{-1} - static_cast<Int>(argument);
+  }
+  Real floating() {
+    switch (input_.get()) {
+      case 0xF9: {
+        const auto half = input_.big_endian<std::uint16_t>();
+        const auto exponent = static_cast<int>((half >> 10U) & 0x1FU);
+        const auto mantissa = static_cast<Real>(half & 0x3FFU);
+        Real value = 0;
+        switch (exponent) {
+          case 0: value = std::ldexp(mantissa, -24); break;
+          case 31:
+            value = mantissa == 0 ? std::numeric_limits<Real>::infinity()
+                                  : std::numeric_limits<Real>::quiet_NaN();
+            break;
+          default: value = std::ldexp(mantissa + 1024, exponent - 25); break;
+        }
+        return (half & 0x8000U) != 0 ? -value : value;
+      }
+      case 0xFA: return static_cast<Real>(input_.big_endian<float>());
+      default: return input_.big_endian<double>();
+    }
+  }
+
+  // Reads a byte or text string with major type `major`, which may consist of chunks.
+  std::string_view chunks(unsigned major) {
+    const std::uint8_t byte = input_.get();
+    if ((byte & 0x1FU) != 31) {
+      return input_.take(length(argument(byte)));
+    }
+    buffer_.clear();
+    while (input_.peek() != 0xFF) {
+      const std::uint8_t chunk = input_.get();
+      if (chunk >> 5U != major || (chunk & 0x1FU) == 31) {
+        invalid_byte(chunk);
+      }
+      buffer_.append(input_.take(length(argument(chunk))));
+    }
+    input_.get();
+    return buffer_;
+  }
+
+  void begin_container(unsigned major, std::string_view type) {
+    const std::uint8_t byte = input_.peek();
+    if (byte >> 5U != major) {
+      type_error(type);
+    }
+    if (stack_.depth() == max_depth_) {
+      input_.error("CBOR", fmt::format("maximum nesting depth of {} exceeded", max_depth_));
+    }
+    input_.get();
+    stack_.push(
+      (byte & 0x1FU) == 31 ? detail::ContainerStack::indefinite : length(argument(byte)),
+      major == 5);
+  }
+  bool next_entry() {
+    const bool at_break = stack_.is_indefinite() && input_.peek() == 0xFF;
+    if (!stack_.next(at_break)) {
+      if (at_break) {
+        input_.get();
+      }
+      return false;
+    }
+    return true;
+  }
+
+  std::size_t length(UInt size) const {
+    if (size >= detail::ContainerStack::indefinite) {
+      input_.error("CBOR", "length exceeds the address space");
+    }
+    return size;
+  }
+
+  [[noreturn]] void invalid_byte(std::uint8_t byte) const {
+    input_.error("CBOR", fmt::format("invalid byte: 0x{:02X}", byte));
+  }
+
+  // Mirrors the `type_error`s thrown when converting a DOM value to the wrong type.
+  [[noreturn]] void type_error(std::string_view expected) const {
+    const std::uint8_t byte = input_.peek();
+    const char* actual = nullptr;
+    switch (byte >> 5U) {
+      case 0:
+      case 1: actual = "number"; break;
+      case 2: actual = "binary"; break;
+      case 3: actual = "string"; break;
+      case 4: actual = "array"; break;
+      case 5: actual = "object"; break;
+      case 7:
+        if (byte == 0xF4 || byte == 0xF5) {
+          actual = "boolean";
+          break;
+        }
+        if (byte == 0xF6) {
+          actual = "null";
+          break;
+        }
+        if (byte >= 0xF9 && byte <= 0xFB) {
+          actual = "number";
+          break;
+        }
+        invalid_byte(byte);
+      default: invalid_byte(byte);
+    }
+    throw Json::type_error::create(302, fmt::format("type must be {}, but is {}", expected, actual),
+                                   nullptr);
+  }
+
+  detail::ByteInput input_;
+  std::size_t max_depth_;
+  detail::ContainerStack stack_{};
+  std::string buffer_{};
+  // The position of the value after the last key or element, which has not been read
+  // if the position is unchanged
+  std::size_t value_start_{0};
+};
+
+// Writes the CBOR encoding of `value` without building a DOM, producing the same output as
+// `Json::to_cbor(to_json(value))` except that `float`s are always encoded in single precision,
+// see `CborWriter::floating32`.
+template<JsonSink TSink, typename T>
+inline void write_cbor(TSink& sink, const T& value) {
+  CborWriter writer{sink};
+  write_value(writer, value);
+}
+template<typename T>
+inline std::vector<std::uint8_t> to_cbor(const T& value) {
+  std::vector<std::uint8_t> out{};
+  detail::ByteVectorSink sink{out};
+  write_cbor(sink, value);
+  return out;
+}
+
+// Decodes CBOR directly into a `T` without building a DOM for the whole document.
+// Values which cannot be decoded produce the same errors as `from_json<T>(Json::from_cbor(bytes))`,
+// whereas malformed input is reported by the reader with a `parse_error` of its own.
+template<typename T>
+inline T parse_cbor(std::string_view bytes) {
+  CborReader reader{bytes};
+  return detail::read_document<T>(reader);
+}
+template<typename T>
+inline T parse_cbor(std::span<const std::uint8_t> bytes) {
+  return parse_cbor<T>(
+    std::string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()});
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_CBOR_HPP
@@ -0,0 +1,53 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_CODEC_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_CODEC_HPP
+
+#include <concepts>
+#include <string_view>
+
+#include "jaybird/base/defs.hpp"
+#include "jaybird/serialization/cbor.hpp"
+#include "jaybird/serialization/msgpack.hpp"
+#include "jaybird/serialization/serialization.hpp"
+#include "jaybird/serialization/writer.hpp"
+
+namespace jay {
+// The formats supported by `encode` and `decode`, all of which use the same converters.
+enum struct Format { json, cbor, msgpack };
+
+// Writes `value` in the given format without building a DOM, where `indent` is only used
+// for JSON (see `write_json`).
+template<JsonSink TSink, typename T>
+inline void encode(TSink& sink, const T& value, Format format, int indent = -1) {
+  switch (format) {
+    case Format::json: write_json(sink, value, indent); break;
+    case Format::cbor: write_cbor(sink, value); break;
+    case Format::msgpack: write_msgpack(sink, value); break;
+  }
+}
+
+// Decodes a `T` from the given format without building a DOM (unless `T` is `Json`).
+template<typename T>
+inline T decode(std::string_view bytes, Format format) {
+  if constexpr (std::same_as<T, Json>) {
+    switch (format) {
+      case Format::cbor: return Json::from_cbor(bytes);
+      case Format::msgpack: return Json::from_msgpack(bytes);
+      default: return Json::parse(bytes);
+    }
+  } else {
+    switch (format) {
+      case Format::cbor: return parse_cbor<T>(bytes);
+      case Format::msgpack: return parse_msgpack<T>(bytes);
+      default: return parse<T>(bytes);
+    }
+  }
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_CODEC_HPP
@@ -0,0 +1,239 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_DOM_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_DOM_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/format.hpp"
+
+#include "jaybird/base/defs.hpp"
+#include "jaybird/serialization/serialization.hpp"
+
+// Converters for DOMs other than `Json`, i.e. other specializations of `nlohmann::basic_json`
+// such as `ArenaJson`. These are read and written through the streaming interface of the
+// converters, so that each value is converted directly without an intermediate `Json`.
+namespace jay {
+// A pull reader with the interface of `JsonReader` which walks a DOM.
+template<BasicJson TJson>
+struct DomReader {
+  explicit DomReader(const TJson& json) : current_{&json} {}
+
+  [[nodiscard]] bool is_null() const {
+    return current_->is_null();
+  }
+
+  void null() const {
+    if (!current_->is_null()) {
+      type_error("null");
+    }
+  }
+  [[nodiscard]] bool boolean() const {
+    if (!current_->is_boolean()) {
+      type_error("boolean");
+    }
+    return current_->template get<bool>();
+  }
+  template<typename T>
+  [[nodiscard]] T number() const {
+    if (!current_->is_number()) {
+      type_error("number");
+    }
+    return current_->template get<T>();
+  }
+  // The returned view is valid as long as the DOM is.
+  [[nodiscard]] std::string_view string_view() const {
+    if (!current_->is_string()) {
+      type_error("string");
+    }
+    return current_->template get_ref<const typename TJson::string_t&>();
+  }
+  [[nodiscard]] std::string string() const {
+    return std::string{string_view()};
+  }
+
+  void begin_object() {
+    if (!current_->is_object()) {
+      type_error("object");
+    }
+    const auto& obj = current_->template get_ref<const typename TJson::object_t&>();
+    objects_.push_back({obj.begin(), obj.end()});
+    containers_.push_back(Container::object);
+  }
+  std::optional<std::string_view> key() {
+    auto& [it, end] = objects_.back();
+    if (it == end) {
+      objects_.pop_back();
+      containers_.pop_back();
+      return std::nullopt;
+    }
+    const auto& [k, value] = *it++;
+    current_ = &value;
+    return k;
+  }
+
+  void begin_array() {
+    if (!current_->is_array()) {
+      type_error("array");
+    }
+    const auto& arr = current_->template get_ref<const typename TJson::array_t&>();
+    arrays_.push_back({arr.begin(), arr.end()});
+    containers_.push_back(Container::array);
+  }
+  bool element() {
+    auto& [it, end] = arrays_.back();
+    if (it == end) {
+      arrays_.pop_back();
+      containers_.pop_back();
+      return false;
+    }
+    current_ = &*it++;
+    return true;
+  }
+
+  [[nodiscard]] Json dom() const {
+    if constexpr (std::same_as<TJson, Json>) {
+      return *current_;
+    } else {
+      return Json(*current_);
+    }
+  }
+  void skip() const {}
+  void finish() const {}
+
+  [[nodiscard]] std::size_t depth() const {
+    return containers_.size();
+  }
+  // Closes the arrays and objects nested deeper than `depth`, after which reading continues
+  // with the next entry of the enclosing container.
+  void recover(std::size_t depth) {
+    while (containers_.size() > depth) {
+      if (containers_.back() == Container::object) {
+        objects_.pop_back();
+      } else {
+        arrays_.pop_back();
+      }
+      containers_.pop_back();
+    }
+  }
+
+private:
+  enum struct Container : bool { array, object };
+
+  template<typename TIt>
+  struct Range {
+    TIt it;
+    TIt end;
+  };
+
+  [[noreturn]] void type_error(std::string_view expected) const {
+    throw Json::type_error::create(
+      302, fmt::format("type must be {}, but is {}", expected, current_->type_name()), nullptr);
+  }
+
+  const TJson* current_;
+  std::vector<Range<typename TJson::object_t::const_iterator>> objects_{};
+  std::vector<Range<typename TJson::array_t::const_iterator>> arrays_{};
+  std::vector<Container> containers_{};
+};
+
+// A writer with the interface of `JsonWriter` which builds a DOM.
+template<BasicJson TJson>
+struct DomWriter {
+  void null() {
+    place() = nullptr;
+  }
+  void boolean(bool value) {
+    place() = value;
+  }
+  void integer(Int value) {
+    place() = value;
+  }
+  void unsigned_integer(UInt value) {
+    place() = value;
+  }
+  void floating(Real value) {
+    place() = value;
+  }
+  void string(std::string_view str) {
+    place() = typename TJson::string_t{str};
+  }
+
+  void begin_object(std::size_t /*size*/) {
+    TJson& json = place();
+    json = TJson::object();
+    stack_.push_back(&json);
+  }
+  void key(std::string_view key) {
+    slot_ = &(*stack_.back())[typename TJson::string_t{key}];
+  }
+  void end_object() {
+    stack_.pop_back();
+  }
+
+  void begin_array(std::size_t size) {
+    TJson& json = place();
+    json = TJson::array();
+    json.template get_ref<typename TJson::array_t&>().reserve(size);
+    stack_.push_back(&json);
+  }
+  void element() {}
+  void end_array() {
+    stack_.pop_back();
+  }
+
+  TJson release() && {
+    return std::move(root_);
+  }
+
+private:
+  // The value which is written next: The root, a new element of the innermost array,
+  // or the entry of the innermost object with the last key.
+  TJson& place() {
+    if (stack_.empty()) {
+      return root_;
+    }
+    if (TJson& parent = *stack_.back(); parent.is_array()) {
+      return parent.emplace_back();
+    }
+    return *slot_;
+  }
+
+  TJson root_{};
+  std::vector<TJson*> stack_{};
+  TJson* slot_{nullptr};
+};
+
+// Converts a value to a DOM of type `TJson`, which is the same as `to_json` for `Json`.
+template<BasicJson TJson, typename T>
+inline TJson to_basic_json(const T& value) {
+  if constexpr (std::same_as<TJson, Json>) {
+    return to_json(value);
+  } else {
+    DomWriter<TJson> writer{};
+    write_value(writer, value);
+    return std::move(writer).release();
+  }
+}
+
+// Converts a DOM other than `Json`, producing the same errors as `from_json` for `Json`.
+template<typename T, BasicJson TJson>
+requires(!std::same_as<TJson, Json>)
+inline T from_json(const TJson& json) {
+  DomReader<TJson> reader{json};
+  return detail::read_document<T>(reader);
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_DOM_HPP
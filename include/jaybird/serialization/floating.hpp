@@ -0,0 +1,38 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_FLOATING_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_FLOATING_HPP
+
+#include <array>
+#include <charconv>
+#include <cmath>
+
+#include "jaybird/base/defs.hpp"
+
+namespace jay {
+namespace detail {
+// The double closest to the shortest decimal representation of a `float`, which is how `float`s
+// are stored in DOMs and written as JSON, so that e.g. `0.1F` is written as `0.1` instead of
+// `0.10000000149011612`.
+// The exact widening is used if the result would not convert back to the same `float` since
+// it is rounded twice, which is the case for a single float (`7.038531e-26F`).
+inline Real widen_float(float value) {
+  if (!std::isfinite(value)) {
+    return static_cast<Real>(value);
+  }
+  // The shortest scientific notation has at most 15 characters, e.g. `-1.1754944e-38`
+  std::array<char, 16> buffer{};
+  const auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value,
+                                       std::chars_format::scientific);
+  Real out{};
+  std::from_chars(buffer.data(), end, out);
+  return static_cast<float>(out) == value ? out : static_cast<Real>(value);
+}
+} // namespace detail
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_FLOATING_HPP
@@ -0,0 +1,488 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_MSGPACK_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_MSGPACK_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/format.hpp"
+
+#include "jaybird/base/defs.hpp"
+#include "jaybird/serialization/binary.hpp"
+#include "jaybird/serialization/serialization.hpp"
+#include "jaybird/serialization/writer.hpp"
+
+namespace jay {
+// Emits MessagePack with the same encoding as `Json::to_msgpack`, i.e. using the smallest
+// representation of integers, lengths, and floats where they are exact.
+template<JsonSink TSink>
+struct MsgPackWriter {
+  explicit MsgPackWriter(TSink& sink) : sink_{sink} {}
+
+  void null() {
+    byte(0xC0);
+  }
+  void boolean(bool value) {
+    byte(value ? 0xC3 : 0xC2);
+  }
+  void integer(Int value) {
+    if (value >= 0) {
+      unsigned_integer(static_cast<UInt>(value));
+    } else if (value >= -32) {
+      sink_.put(static_cast<char>(value));
+    } else if (value >= std::numeric_limits<std::int8_t>::min()) {
+      byte(0xD0);
+      sink_.put(static_cast<char>(value));
+    } else if (value >= std::numeric_limits<std::int16_t>::min()) {
+      byte(0xD1);
+      detail::write_big_endian(sink_, static_cast<std::int16_t>(value));
+    } else if (value >= std::numeric_limits<std::int32_t>::min()) {
+      byte(0xD2);
+      detail::write_big_endian(sink_, static_cast<std::int32_t>(value));
+    } else {
+      byte(0xD3);
+      detail::write_big_endian(sink_, value);
+    }
+  }
+  void unsigned_integer(UInt value) {
+    if (value < 128) {
+      byte(static_cast<unsigned>(value));
+    } else if (value <= std::numeric_limits<std::uint8_t>::max()) {
+      byte(0xCC);
+      byte(static_cast<unsigned>(value));
+    } else if (value <= std::numeric_limits<std::uint16_t>::max()) {
+      byte(0xCD);
+      detail::write_big_endian(sink_, static_cast<std::uint16_t>(value));
+    } else if (value <= std::numeric_limits<std::uint32_t>::max()) {
+      byte(0xCE);
+      detail::write_big_endian(sink_, static_cast<std::uint32_t>(value));
+    } else {
+      byte(0xCF);
+      detail::write_big_endian(sink_, value);
+    }
+  }
+  void floating(Real value) {
+    if (detail::is_compact_float(value)) {
+      byte(0xCA);
+      detail::write_big_endian(sink_, static_cast<float>(value));
+    } else {
+      byte(0xCB);
+      detail::write_big_endian(sink_, value);
+    }
+  }
+  // A finite `float` is always written in single precision, whereas the double in the DOM
+  // produced by `to_json` is only written in single precision if it is exact.
+  void floating32(float value) {
+    if (!std::isfinite(value)) {
+      floating(static_cast<Real>(value));
+      return;
+    }
+    byte(0xCA);
+    detail::write_big_endian(sink_, value);
+  }
+  void string(std::string_view str) {
+    const std::size_t size = str.size();
+    if (size <= 31) {
+      byte(0xA0U | static_cast<unsigned>(size));
+    } else if (size <= std::numeric_limits<std::uint8_t>::max()) {
+      byte(0xD9);
+      byte(static_cast<unsigned>(size));
+    } else {
+      sized(0xDA, size);
+    }
+    sink_.write(str);
+  }
+
+  void begin_object(std::size_t size) {
+    if (size <= 15) {
+      byte(0x80U | static_cast<unsigned>(size));
+    } else {
+      sized(0xDE, size);
+    }
+  }
+  void key(std::string_view key) {
+    string(key);
+  }
+  void end_object() {}
+
+  void begin_array(std::size_t size) {
+    if (size <= 15) {
+      byte(0x90U | static_cast<unsigned>(size));
+    } else {
+      sized(0xDC, size);
+    }
+  }
+  void element() {}
+  void end_array() {}
+
+private:
+  void byte(unsigned value) {
+    sink_.put(static_cast<char>(value));
+  }
+  // Writes a 16-bit length after `prefix` or a 32-bit length after `prefix + 1`.
+  void sized(unsigned prefix, std::size_t size) {
+    if (size <= std::numeric_limits<std::uint16_t>::max()) {
+      byte(prefix);
+      detail::write_big_endian(sink_, static_cast<std::uint16_t>(size));
+    } else {
+      byte(prefix + 1);
+      detail::write_big_endian(sink_, static_cast<std::uint32_t>(size));
+    }
+  }
+
+  TSink& sink_;
+};
+
+// A pull parser for MessagePack with the interface of `JsonReader`.
+struct MsgPackReader {
+  explicit MsgPackReader(std::string_view bytes, std::size_t max_depth = default_max_depth)
+      : input_{bytes}, max_depth_{max_depth} {}
+
+  [[nodiscard]] bool is_null() const {
+    return !input_.at_end() && input_.peek() == 0xC0;
+  }
+
+  void null() {
+    if (input_.peek() != 0xC0) {
+      type_error("null");
+    }
+    input_.get();
+  }
+  bool boolean() {
+    const std::uint8_t byte = input_.peek();
+    if (byte != 0xC2 && byte != 0xC3) {
+      type_error("boolean");
+    }
+    input_.get();
+    return byte == 0xC3;
+  }
+  template<typename T>
+  T number() {
+    auto convert = []<typename TValue>(TValue value) -> T {
+      if constexpr (std::same_as<TValue, T>) {
+        return value;
+      } else {
+        return static_cast<T>(value);
+      }
+    };
+    const std::uint8_t byte = input_.peek();
+    if (byte <= 0x7F || (byte >= 0xCC && byte <= 0xCF)) {
+      return convert(unsigned_number());
+    }
+    if (byte >= 0xE0 || (byte >= 0xD0 && byte <= 0xD3)) {
+      return convert(signed_number());
+    }
+    if (byte == 0xCA || byte == 0xCB) {
+      return convert(floating());
+    }
+    type_error("number");
+  }
+  // The returned view is valid until the next member function call.
+  std::string_view string_view() {
+    if (!is_string(input_.peek())) {
+      type_error("string");
+    }
+    return raw_string();
+  }
+  std::string string() {
+    return std::string{string_view()};
+  }
+
+  void begin_object() {
+    const std::uint8_t byte = input_.peek();
+    if ((byte & 0xF0U) == 0x80) {
+      check_depth();
+      input_.get();
+      stack_.push(byte & 0x0FU, true);
+    } else if (byte == 0xDE || byte == 0xDF) {
+      check_depth();
+      stack_.push(length(byte - 0xDEU + 1), true);
+    } else {
+      type_error("object");
+    }
+  }
+  // The returned key is valid until the next member function call.
+  std::optional<std::string_view> key() {
+    if (!stack_.next(false)) {
+      return std::nullopt;
+    }
+    if (!is_string(input_.peek())) {
+      input_.error("MessagePack", "expected a string as object key");
+    }
+    const std::string_view out = raw_string();
+    value_start_ = input_.position();
+    return out;
+  }
+
+  void begin_array() {
+    const std::uint8_t byte = input_.peek();
+    if ((byte & 0xF0U) == 0x90) {
+      check_depth();
+      input_.get();
+      stack_.push(byte & 0x0FU, false);
+    } else if (byte == 0xDC || byte == 0xDD) {
+      check_depth();
+      stack_.push(length(byte - 0xDCU + 1), false);
+    } else {
+      type_error("array");
+    }
+  }
+  bool element() {
+    if (!stack_.next(false)) {
+      return false;
+    }
+    value_start_ = input_.position();
+    return true;
+  }
+
+  // Reads the next value into a DOM, e.g. for types without a streaming implementation.
+  Json dom() {
+    const std::uint8_t byte = input_.peek();
+    if (byte <= 0x7F || (byte >= 0xCC && byte <= 0xCF)) {
+      return unsigned_number();
+    }
+    if (byte >= 0xE0 || (byte >= 0xD0 && byte <= 0xD3)) {
+      return signed_number();
+    }
+    if (is_string(byte)) {
+      return string();
+    }
+    if ((byte & 0xF0U) == 0x80 || byte == 0xDE || byte == 0xDF) {
+      auto out = Json::object();
+      begin_object();
+      while (const auto k = key()) {
+        Json& slot = out[std::string{*k}];
+        slot = dom();
+      }
+      return out;
+    }
+    if ((byte & 0xF0U) == 0x90 || byte == 0xDC || byte == 0xDD) {
+      auto out = Json::array();
+      begin_array();
+      while (element()) {
+        out.push_back(dom());
+      }
+      return out;
+    }
+    switch (byte) {
+      case 0xC0: input_.get(); return nullptr;
+      case 0xC2: input_.get(); return false;
+      case 0xC3: input_.get(); return true;
+      case 0xCA:
+      case 0xCB: return floating();
+      case 0xC4:
+      case 0xC5:
+      case 0xC6: {
+        const std::string_view bytes = input_.take(length(byte - 0xC4U));
+        return Json::binary(std::vector<std::uint8_t>(bytes.begin(), bytes.end()));
+      }
+      case 0xC7:
+      case 0xC8:
+      case 0xC9:
+      case 0xD4:
+      case 0xD5:
+      case 0xD6:
+      case 0xD7:
+      case 0xD8: {
+        std::size_t size = 0;
+        if (byte >= 0xD4) {
+          input_.get();
+          size = std::size_t{1} << (byte - 0xD4U);
+        } else {
+          size = length(byte - 0xC7U);
+        }
+        const std::uint8_t subtype = input_.get();
+        const std::string_view bytes = input_.take(size);
+        return Json::binary(std::vector<std::uint8_t>(bytes.begin(), bytes.end()), subtype);
+      }
+      default: input_.error("MessagePack", fmt::format("invalid byte: 0x{:02X}", byte));
+    }
+  }
+
+  // Skips the next value, validating it like `dom` would.
+  void skip() {
+    const std::uint8_t byte = input_.peek();
+    if ((byte & 0xF0U) == 0x80 || byte == 0xDE || byte == 0xDF) {
+      begin_object();
+      while (key().has_value()) {
+        skip();
+      }
+    } else if ((byte & 0xF0U) == 0x90 || byte == 0xDC || byte == 0xDD) {
+      begin_array();
+      while (element()) {
+        skip();
+      }
+    } else if (is_string(byte)) {
+      raw_string();
+    } else {
+      dom();
+    }
+  }
+
+  // The number of arrays and maps which are currently open.
+  [[nodiscard]] std::size_t depth() const {
+    return stack_.depth();
+  }
+  // Skips the rest of a value which could not be decoded until only `depth` arrays and maps
+  // are open, validating it like `skip`, so that reading can continue after the value.
+  void recover(std::size_t depth) {
+    if (input_.position() == value_start_) {
+      skip();
+    }
+    while (stack_.depth() > depth) {
+      if (stack_.is_object()) {
+        while (key().has_value()) {
+          skip();
+        }
+      } else {
+        while (element()) {
+          skip();
+        }
+      }
+    }
+  }
+
+  // Ensures that the input contains nothing after the last value.
+  void finish() const {
+    if (!input_.at_end()) {
+      input_.error("MessagePack", "expected end of input");
+    }
+  }
+
+  [[nodiscard]] std::size_t position() const {
+    return input_.position();
+  }
+
+private:
+  void check_depth() const {
+    if (stack_.depth() == max_depth_) {
+      input_.error("MessagePack", fmt::format("maximum nesting depth of {} exceeded", max_depth_));
+    }
+  }
+
+  static bool is_string(std::uint8_t byte) {
+    return (byte & 0xE0U) == 0xA0 || (byte >= 0xD9 && byte <= 0xDB);
+  }
+
+  // Consumes the marker and reads a length with 2^`size_log` bytes (1, 2, or 4).
+  std::size_t length(unsigned size_log) {
+    input_.get();
+    switch (size_log) {
+      case 0: return input_.get();
+      case 1: return input_.big_endian<std::uint16_t>();
+      default: return input_.big_endian<std::uint32_t>();
+    }
+  }
+  std::string_view raw_string() {
+    const std::uint8_t byte = input_.peek();
+    if ((byte & 0xE0U) == 0xA0) {
+      input_.get();
+      return input_.take(byte & 0x1FU);
+    }
+    return input_.take(length(byte - 0xD9U));
+  }
+
+  UInt unsigned_number() {
+    const std::uint8_t byte = input_.get();
+    switch (byte) {
+      case 0xCC: return input_.get();
+      case 0xCD: return input_.big_endian<std::uint16_t>();
+      case 0xCE: return input_.big_endian<std::uint32_t>();
+      case 0xCF: return input_.big_endian<std::uint64_t>();
+      default: return byte;
+    }
+  }
+  Int signed_number() {
+    const std::uint8_t byte = input_.get();
+    switch (byte) {
+      case 0xD0: return static_cast<std::int8_t>(input_.get());
+      case 0xD1: return input_.big_endian<std::int16_t>();
+      case 0xD2: return input_.big_endian<std::int32_t>();
+      case 0xD3: return input_.big_endian<std::int64_t>();
+      default: return static_cast<std::int8_t>(byte);
+    }
+  }
+  Real floating() {
+    if (input_.get() == 0xCA) {
+      return static_cast<Real>(input_.big_endian<float>());
+    }
+    return input_.big_endian<double>();
+  }
+
+  // Mirrors the `type_error`s thrown when converting a DOM value to the wrong type.
+  [[noreturn]] void type_error(std::string_view expected) const {
+    const std::uint8_t byte = input_.peek();
+    const char* actual = "binary";
+    if (byte <= 0x7F || byte >= 0xE0 || (byte >= 0xCA && byte <= 0xD3)) {
+      actual = "number";
+    } else if ((byte & 0xF0U) == 0x80 || byte == 0xDE || byte == 0xDF) {
+      actual = "object";
+    } else if ((byte & 0xF0U) == 0x90 || byte == 0xDC || byte == 0xDD) {
+      actual = "array";
+    } else if (is_string(byte)) {
+      actual = "string";
+    } else if (byte == 0xC0) {
+      actual = "null";
+    } else if (byte == 0xC2 || byte == 0xC3) {
+      actual = "boolean";
+    } else if (byte == 0xC1) {
+      input_.error("MessagePack", "invalid byte: 0xC1");
+    }
+    throw Json::type_error::create(302, fmt::format("type must be {}, but is {}", expected, actual),
+                                   nullptr);
+  }
+
+  detail::ByteInput input_;
+  std::size_t max_depth_;
+  detail::ContainerStack stack_{};
+  // The position of the value after the last key or element, which has not been read
+  // if the position is unchanged
+  std::size_t value_start_{0};
+};
+
+// Writes the MessagePack encoding of `value` without building a DOM, producing the same output
+// as `Json::to_msgpack(to_json(value))` except that `float`s are always encoded in single
+// precision, see `MsgPackWriter::floating32`.
+template<JsonSink TSink, typename T>
+inline void write_msgpack(TSink& sink, const T& value) {
+  MsgPackWriter writer{sink};
+  write_value(writer, value);
+}
+template<typename T>
+inline std::vector<std::uint8_t> to_msgpack(const T& value) {
+  std::vector<std::uint8_t> out{};
+  detail::ByteVectorSink sink{out};
+  write_msgpack(sink, value);
+  return out;
+}
+
+// Decodes MessagePack directly into a `T` without building a DOM for the whole document.
+// Values which cannot be decoded produce the same errors as
+// `from_json<T>(Json::from_msgpack(bytes))`, whereas malformed input is reported by the reader
+// with a `parse_error` of its own.
+template<typename T>
+inline T parse_msgpack(std::string_view bytes) {
+  MsgPackReader reader{bytes};
+  return detail::read_document<T>(reader);
+}
+template<typename T>
+inline T parse_msgpack(std::span<const std::uint8_t> bytes) {
+  return parse_msgpack<T>(
+    std::string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()});
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_MSGPACK_HPP
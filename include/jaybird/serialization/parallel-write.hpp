@@ -0,0 +1,107 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_PARALLEL_WRITE_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_PARALLEL_WRITE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <ranges>
+#include <string>
+
+#include "jaybird/base/parallel.hpp"
+#include "jaybird/serialization/serialization.hpp"
+#include "jaybird/serialization/writer.hpp"
+
+namespace jay {
+namespace detail {
+// Renders the records with indices from `begin` to `end` as they appear in the output.
+template<typename TRange>
+inline std::string render_records(const TRange& range, std::size_t begin, std::size_t end,
+                                  RecordLayout layout, int indent, std::size_t size_hint) {
+  std::string out{};
+  out.reserve(size_hint);
+  ContainerSink sink{out};
+  auto it = std::ranges::next(std::ranges::begin(range),
+                             static_cast<std::ranges::range_difference_t<const TRange>>(begin));
+  for (std::size_t i = begin; i < end; ++i, ++it) {
+    if (layout == RecordLayout::json_lines) {
+      write_json(sink, *it);
+      out.push_back('\n');
+      continue;
+    }
+    if (i > 0) {
+      out.push_back(',');
+    }
+    if (indent >= 0) {
+      out.push_back('\n');
+      out.append(static_cast<std::size_t>(indent), ' ');
+    }
+    JsonWriter writer{sink, indent, 1};
+    write_value(writer, *it);
+  }
+  return out;
+}
+} // namespace detail
+
+// Writes the records in `range` as a top-level array or as JSON Lines, where contiguous slices
+// of about `options.chunk_size` bytes are serialized into separate buffers on worker threads,
+// which are passed to the sink in order.
+// The output is the same as that of `write_json` for an array (with the given indentation)
+// and of `JsonLinesWriter` for JSON Lines (where `indent` is ignored).
+template<std::ranges::random_access_range TRange, JsonSink TSink>
+requires std::ranges::sized_range<TRange>
+inline void write_range(const TRange& range, TSink& sink, const ParallelOptions& options = {},
+                        RecordLayout layout = RecordLayout::array, int indent = -1) {
+  if (layout == RecordLayout::detect) {
+    layout = RecordLayout::array;
+  }
+  const auto size = static_cast<std::size_t>(std::ranges::size(range));
+  if (layout == RecordLayout::array) {
+    sink.put('[');
+  }
+
+  if (size > 0) {
+    // The size of the first record is used to estimate how many records make up a slice
+    const std::string first = detail::render_records(range, 0, 1, layout, indent, 0);
+    const std::size_t per_slice = std::max<std::size_t>(options.chunk_size / first.size(), 1);
+    const std::size_t slice_num = (size - 1 + per_slice - 1) / per_slice;
+    const std::size_t size_hint = per_slice * first.size() * 5 / 4;
+
+    ParallelOptions ordered = options;
+    ordered.ordered = true;
+    sink.write(first);
+    parallel_pipeline(
+      slice_num,
+      [&](std::size_t i) {
+        const std::size_t begin = 1 + i * per_slice;
+        return detail::render_records(range, begin, std::min(begin + per_slice, size), layout,
+                                      indent, size_hint);
+      },
+      [&](std::string&& slice) { sink.write(slice); }, ordered);
+  }
+
+  if (layout == RecordLayout::array) {
+    if (size > 0 && indent >= 0) {
+      sink.put('\n');
+    }
+    sink.put(']');
+  }
+}
+template<std::ranges::random_access_range TRange>
+requires std::ranges::sized_range<TRange>
+inline void write_range(const TRange& range, std::FILE* handle,
+                        const ParallelOptions& options = {},
+                        RecordLayout layout = RecordLayout::array, int indent = -1) {
+  FileSink sink{handle};
+  write_range(range, sink, options, layout, indent);
+  sink.flush();
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_PARALLEL_WRITE_HPP
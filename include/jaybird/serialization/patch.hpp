@@ -0,0 +1,299 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_PATCH_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_PATCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/macropolis.hpp"
+#include "thesauros/ranges.hpp"
+
+#include "jaybird/base/defs.hpp"
+#include "jaybird/serialization/serialization.hpp"
+
+// JSON Patches (RFC 6902) between typed values, which only visit the members that differ
+// instead of converting both values to DOMs.
+namespace jay {
+namespace detail {
+template<HasTypeInfo T, std::size_t tSlot>
+using SlotMember = std::decay_t<decltype(thes::star::get_at<JsonConverter<T>::slots[tSlot].index>(
+  thes::TypeInfo<T>::members))>;
+
+// Compares values without converting them to DOMs where possible: Described types without `==`
+// are compared member by member and the standard containers element by element, as their
+// `==` is not constrained on that of their elements.
+template<typename T>
+inline bool values_equal(const T& a, const T& b);
+template<typename T>
+inline bool values_equal(const std::optional<T>& a, const std::optional<T>& b);
+template<typename T1, typename T2>
+inline bool values_equal(const std::pair<T1, T2>& a, const std::pair<T1, T2>& b);
+template<typename... Ts>
+inline bool values_equal(const std::tuple<Ts...>& a, const std::tuple<Ts...>& b);
+template<typename... Ts>
+inline bool values_equal(const std::variant<Ts...>& a, const std::variant<Ts...>& b);
+
+template<typename T>
+inline bool values_equal(const T& a, const T& b) {
+  if constexpr (HasTypeInfo<T> && !std::equality_comparable<T>) {
+    return thes::TypeInfo<T>::members | thes::star::apply([&]<typename... TMembers>(TMembers...) {
+             return (... && values_equal(a.*TMembers::pointer, b.*TMembers::pointer));
+           });
+  } else if constexpr (std::ranges::sized_range<const T> &&
+                       !std::convertible_to<const T&, std::string_view>) {
+    auto equal = [](const auto& x, const auto& y) { return values_equal(x, y); };
+    return std::ranges::size(a) == std::ranges::size(b) && std::ranges::equal(a, b, equal);
+  } else if constexpr (std::equality_comparable<T>) {
+    return a == b;
+  } else {
+    return to_json(a) == to_json(b);
+  }
+}
+template<typename T>
+inline bool values_equal(const std::optional<T>& a, const std::optional<T>& b) {
+  return a.has_value() == b.has_value() && (!a.has_value() || values_equal(*a, *b));
+}
+template<typename T1, typename T2>
+inline bool values_equal(const std::pair<T1, T2>& a, const std::pair<T1, T2>& b) {
+  return values_equal(a.first, b.first) && values_equal(a.second, b.second);
+}
+template<typename... Ts>
+inline bool values_equal(const std::tuple<Ts...>& a, const std::tuple<Ts...>& b) {
+  return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+    return (... && values_equal(std::get<tIdxs>(a), std::get<tIdxs>(b)));
+  }(std::index_sequence_for<Ts...>{});
+}
+template<typename... Ts>
+inline bool values_equal(const std::variant<Ts...>& a, const std::variant<Ts...>& b) {
+  return a.index() == b.index() && std::visit(
+                                     [&]<typename T>(const T& value) {
+                                       return values_equal(value, *std::get_if<T>(&b));
+                                     },
+                                     a);
+}
+
+template<typename... Ts>
+inline constexpr bool has_distinct_names = [] {
+  std::array<std::string_view, sizeof...(Ts)> names{thes::serial_name_of<Ts>().view()...};
+  std::ranges::sort(names);
+  return std::ranges::adjacent_find(names) == names.end();
+}();
+
+template<typename T>
+inline void append_diff(Json& patch, const T& source, const T& target, const std::string& path) {
+  Json ops = Json::diff(to_json(source), to_json(target), path);
+  auto& out = patch.get_ref<Json::array_t&>();
+  auto& in = ops.get_ref<Json::array_t&>();
+  out.insert(out.end(), std::make_move_iterator(in.begin()), std::make_move_iterator(in.end()));
+}
+
+template<typename T>
+inline void diff_into(Json& patch, const T& source, const T& target, const std::string& path);
+template<typename... Ts>
+inline void diff_into(Json& patch, const std::variant<Ts...>& source,
+                      const std::variant<Ts...>& target, const std::string& path);
+
+template<HasTypeInfo T, std::size_t tSlot>
+inline void diff_slot(Json& patch, const T& source, const T& target, const std::string& path) {
+  // Static members are the same in both values
+  if constexpr (constexpr auto slot = JsonConverter<T>::slots[tSlot]; !slot.is_static) {
+    constexpr auto pointer = SlotMember<T, tSlot>::pointer;
+    diff_into(patch, source.*pointer, target.*pointer,
+              path + '/' + nlohmann::detail::escape(std::string{slot.key}));
+  }
+}
+
+// Described types are compared member by member in the order of their keys, which produces
+// the same operations as `Json::diff`. All other values are only converted to DOMs for
+// `Json::diff` if they differ.
+template<typename T>
+inline void diff_into(Json& patch, const T& source, const T& target, const std::string& path) {
+  if constexpr (HasTypeInfo<T>) {
+    [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      (diff_slot<T, tIdxs>(patch, source, target, path), ...);
+    }(std::make_index_sequence<JsonConverter<T>::slots.size()>{});
+  } else if (!values_equal(source, target)) {
+    append_diff(patch, source, target, path);
+  }
+}
+// Variants with the same alternative are compared within the object `{name: value}`.
+template<typename... Ts>
+inline void diff_into(Json& patch, const std::variant<Ts...>& source,
+                      const std::variant<Ts...>& target, const std::string& path) {
+  if (source.index() != target.index()) {
+    append_diff(patch, source, target, path);
+    return;
+  }
+  std::visit(
+    [&]<typename T>(const T& value) {
+      const std::string key{thes::serial_name_of<T>().view()};
+      diff_into(patch, value, *std::get_if<T>(&target), path + '/' + nlohmann::detail::escape(key));
+    },
+    source);
+}
+
+// Applies an operation to the DOM of a value, which is nested in objects with the keys in
+// `prefix` so that the paths and errors are those of the whole document.
+template<typename T>
+inline void apply_json_operation(T& value, const Json& op, std::string_view prefix) {
+  Json root{};
+  Json* slot = &root;
+  for (std::string_view rest = prefix; !rest.empty();) {
+    const std::size_t end = std::min(rest.find('/', 1), rest.size());
+    slot = &(*slot)[std::string{rest.substr(1, end - 1)}];
+    rest.remove_prefix(end);
+  }
+  *slot = to_json(value);
+  root.patch_inplace(Json::array({op}));
+  value = from_json<T>(std::move(root.at(Json::json_pointer{std::string{prefix}})));
+}
+
+// The key at `offset` within `path` and the offset after it, unless the key would need to be
+// unescaped or is removed by the operation, which is then applied to the DOM of the parent.
+inline std::optional<std::pair<std::string_view, std::size_t>>
+nested_key(const Json& op, std::string_view path, std::size_t offset) {
+  if (offset == path.size() || path[offset] != '/') {
+    return std::nullopt;
+  }
+  const std::size_t end = std::min(path.find('/', offset + 1), path.size());
+  const std::string_view key = path.substr(offset + 1, end - offset - 1);
+  if (key.find('~') != std::string_view::npos || (op.at("op") == "remove" && end == path.size())) {
+    return std::nullopt;
+  }
+  return std::pair{key, end};
+}
+
+template<typename T>
+inline void apply_operation(T& value, const Json& op, std::string_view path, std::size_t offset);
+template<typename... Ts>
+inline void apply_operation(std::variant<Ts...>& value, const Json& op, std::string_view path,
+                            std::size_t offset);
+
+// Applies an operation to a member or the alternative of a variant, where adding or replacing
+// it only needs to decode the new value.
+template<typename T>
+inline void apply_nested(T& value, const Json& op, std::string_view path, std::size_t offset) {
+  if (offset == path.size() && op.at("op") != "test") {
+    if (const auto it = op.find("value"); it != op.end()) {
+      value = from_json<T>(*it);
+      return;
+    }
+  }
+  apply_operation(value, op, path, offset);
+}
+
+// Applies an operation to the member of a slot, which fails for static members.
+template<HasTypeInfo T, std::size_t tSlot>
+inline bool apply_member(T& value, const Json& op, std::string_view path, std::size_t offset) {
+  if constexpr (JsonConverter<T>::slots[tSlot].is_static) {
+    return false;
+  } else {
+    apply_nested(value.*SlotMember<T, tSlot>::pointer, op, path, offset);
+    return true;
+  }
+}
+
+// Applies an operation whose path starts at `offset` within `path` to a value, where the
+// part before `offset` consists of the keys of the enclosing described types and variants.
+// Operations on a member of a described type are passed on to that member, while all other
+// operations are applied to the DOM of the value, as are operations which remove a member.
+template<typename T>
+inline void apply_operation(T& value, const Json& op, std::string_view path, std::size_t offset) {
+  if constexpr (HasTypeInfo<T>) {
+    using Conv = JsonConverter<T>;
+    if (const auto key = nested_key(op, path, offset); Conv::has_distinct_keys && key) {
+      if (const auto idx = Conv::key_hash.find(key->first); idx.has_value()) {
+        using Fun = bool (*)(T&, const Json&, std::string_view, std::size_t);
+        static constexpr auto members = []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+          return std::array<Fun, sizeof...(tIdxs)>{&apply_member<T, tIdxs>...};
+        }(std::make_index_sequence<Conv::slots.size()>{});
+        if (members[*idx](value, op, path, key->second)) {
+          return;
+        }
+      }
+    }
+  }
+  apply_json_operation(value, op, path.substr(0, offset));
+}
+// Operations on the current alternative are passed on to it if the names are distinct,
+// as the alternative could change otherwise.
+template<typename... Ts>
+inline void apply_operation(std::variant<Ts...>& value, const Json& op, std::string_view path,
+                            std::size_t offset) {
+  if constexpr (has_distinct_names<Ts...>) {
+    if (const auto key = nested_key(op, path, offset)) {
+      const bool is_applied = std::visit(
+        [&]<typename T>(T& alternative) {
+          if (key->first != thes::serial_name_of<T>().view()) {
+            return false;
+          }
+          apply_nested(alternative, op, path, key->second);
+          return true;
+        },
+        value);
+      if (is_applied) {
+        return;
+      }
+    }
+  }
+  apply_json_operation(value, op, path.substr(0, offset));
+}
+
+inline bool is_member_operation(const Json& op) {
+  if (!op.is_object()) {
+    return false;
+  }
+  const auto name = op.find("op");
+  const auto path = op.find("path");
+  return name != op.end() && path != op.end() && path->is_string() &&
+         (*name == "add" || *name == "remove" || *name == "replace" || *name == "test");
+}
+} // namespace detail
+
+// Creates a JSON Patch which transforms `source` into `target`, which is the same as
+// `Json::diff(to_json(source), to_json(target))` for described types, except that members
+// which compare equal are omitted even if their JSON representations differ (e.g. `-0.0`).
+template<typename T>
+inline Json diff(const T& source, const T& target) {
+  auto patch = Json::array();
+  detail::diff_into(patch, source, target, "");
+  return patch;
+}
+
+// Applies a JSON Patch in place, where the work is proportional to the size of the affected
+// members: Operations on members of described types and alternatives of variants only decode
+// the new values, while operations within other values, `move`, and `copy` use their DOMs.
+// As with `Json::patch_inplace`, the preceding operations remain applied if an operation fails.
+template<typename T>
+inline void apply_patch(T& value, const Json& patch) {
+  if (!patch.is_array()) {
+    throw Json::parse_error::create(104, 0, "JSON patch must be an array of objects", &patch);
+  }
+  for (const Json& op : patch) {
+    if (detail::is_member_operation(op)) {
+      detail::apply_operation(value, op, op["path"].get_ref<const std::string&>(), 0);
+    } else {
+      detail::apply_json_operation(value, op, "");
+    }
+  }
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_PATCH_HPP
@@ -0,0 +1,348 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_READER_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_READER_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/format.hpp"
+
+#include "jaybird/base/defs.hpp"
+
+namespace jay {
+// A pull parser which reads JSON text value by value without building a DOM.
+// It uses the lexer of `nlohmann::json`, and syntax errors are reported with the same
+// `parse_error`s as `Json::parse`.
+// Objects are read by calling `begin_object` and then `key` until it returns `std::nullopt`,
+// where each key is followed by exactly one value; arrays are read analogously using
+// `begin_array` and `element`.
+// Arrays and objects may be nested at most `max_depth` levels deep, and deeper input is
+// rejected with a `parse_error`, since the converters recurse once per level.
+template<typename TInput>
+struct JsonReader {
+  using Lexer = nlohmann::detail::lexer<Json, TInput>;
+  using Token = typename nlohmann::detail::lexer_base<Json>::token_type;
+
+  explicit JsonReader(TInput&& input, std::size_t max_depth = default_max_depth)
+      : lexer_{std::move(input)}, max_depth_{max_depth} {
+    advance();
+  }
+
+  [[nodiscard]] bool is_null() const {
+    return token_ == Token::literal_null;
+  }
+
+  void null() {
+    expect_value(Token::literal_null, "null");
+    pending_ = false;
+    advance();
+  }
+  bool boolean() {
+    if (token_ != Token::literal_true && token_ != Token::literal_false) {
+      type_error("boolean");
+    }
+    const bool value = token_ == Token::literal_true;
+    pending_ = false;
+    advance();
+    return value;
+  }
+  template<typename T>
+  T number() {
+    T value{};
+    switch (token_) {
+      case Token::value_integer: value = static_cast<T>(lexer_.get_number_integer()); break;
+      case Token::value_unsigned: value = static_cast<T>(lexer_.get_number_unsigned()); break;
+      case Token::value_float: value = static_cast<T>(checked_float()); break;
+      default: type_error("number");
+    }
+    pending_ = false;
+    advance();
+    return value;
+  }
+  // The returned view is valid until the next member function call.
+  std::string_view string_view() {
+    expect_value(Token::value_string, "string");
+    buffer_ = std::move(lexer_.get_string());
+    pending_ = false;
+    advance();
+    return buffer_;
+  }
+  std::string string() {
+    expect_value(Token::value_string, "string");
+    std::string out = std::move(lexer_.get_string());
+    pending_ = false;
+    advance();
+    return out;
+  }
+
+  void begin_object() {
+    expect_value(Token::begin_object, "object");
+    open(Container::object);
+  }
+  // The returned key is valid until the next member function call.
+  std::optional<std::string_view> key() {
+    const bool first = std::exchange(first_, false);
+    if (token_ == Token::end_object) {
+      close();
+      return std::nullopt;
+    }
+    if (!first) {
+      if (token_ != Token::value_separator) {
+        syntax_error(Token::end_object, "object");
+      }
+      advance();
+    }
+    if (token_ != Token::value_string) {
+      syntax_error(Token::value_string, "object key");
+    }
+    buffer_ = std::move(lexer_.get_string());
+    advance();
+    if (token_ != Token::name_separator) {
+      syntax_error(Token::name_separator, "object separator");
+    }
+    advance();
+    pending_ = true;
+    return buffer_;
+  }
+
+  void begin_array() {
+    expect_value(Token::begin_array, "array");
+    open(Container::array);
+  }
+  bool element() {
+    const bool first = std::exchange(first_, false);
+    if (token_ == Token::end_array) {
+      close();
+      return false;
+    }
+    if (!first) {
+      if (token_ != Token::value_separator) {
+        syntax_error(Token::end_array, "array");
+      }
+      advance();
+    }
+    pending_ = true;
+    return true;
+  }
+
+  // Reads the next value into a DOM, e.g. for types without a streaming implementation.
+  Json dom() {
+    switch (token_) {
+      case Token::literal_null: pending_ = false; advance(); return nullptr;
+      case Token::literal_true: pending_ = false; advance(); return true;
+      case Token::literal_false: pending_ = false; advance(); return false;
+      case Token::value_integer:
+      case Token::value_unsigned:
+      case Token::value_float:
+      case Token::value_string: return scalar_dom();
+      case Token::begin_object: {
+        auto out = Json::object();
+        begin_object();
+        while (const auto k = key()) {
+          Json& slot = out[std::string{*k}];
+          slot = dom();
+        }
+        return out;
+      }
+      case Token::begin_array: {
+        auto out = Json::array();
+        begin_array();
+        while (element()) {
+          out.push_back(dom());
+        }
+        return out;
+      }
+      default: value_error();
+    }
+  }
+
+  // Skips the next value, validating it like `dom` would.
+  void skip() {
+    switch (token_) {
+      case Token::begin_object: {
+        begin_object();
+        while (key().has_value()) {
+          skip();
+        }
+        break;
+      }
+      case Token::begin_array: {
+        begin_array();
+        while (element()) {
+          skip();
+        }
+        break;
+      }
+      case Token::value_float:
+        checked_float();
+        pending_ = false;
+        advance();
+        break;
+      case Token::literal_null:
+      case Token::literal_true:
+      case Token::literal_false:
+      case Token::value_integer:
+      case Token::value_unsigned:
+      case Token::value_string:
+        pending_ = false;
+        advance();
+        break;
+      default: value_error();
+    }
+  }
+
+  // The number of arrays and objects which are currently open.
+  [[nodiscard]] std::size_t depth() const {
+    return containers_.size();
+  }
+  // Skips the rest of a value which could not be decoded until only `depth` arrays and objects
+  // are open, validating it like `skip`, so that reading can continue after the value.
+  void recover(std::size_t depth) {
+    if (pending_) {
+      skip();
+    }
+    while (containers_.size() > depth) {
+      if (containers_.back() == Container::object) {
+        while (key().has_value()) {
+          skip();
+        }
+      } else {
+        while (element()) {
+          skip();
+        }
+      }
+    }
+  }
+
+  // Ensures that the input contains nothing but whitespace after the last value.
+  void finish() {
+    if (token_ != Token::end_of_input) {
+      syntax_error(Token::end_of_input, "value");
+    }
+  }
+
+  // The number of characters read, which includes the token after the current value.
+  [[nodiscard]] std::size_t position() const {
+    return lexer_.get_position().chars_read_total;
+  }
+
+private:
+  enum struct Container : bool { array, object };
+
+  void advance() {
+    token_ = lexer_.scan();
+  }
+
+  void open(Container container) {
+    if (containers_.size() == max_depth_) {
+      throw Json::parse_error::create(
+        101, lexer_.get_position(),
+        fmt::format("maximum nesting depth of {} exceeded", max_depth_), nullptr);
+    }
+    containers_.push_back(container);
+    pending_ = false;
+    advance();
+    first_ = true;
+  }
+  void close() {
+    containers_.pop_back();
+    advance();
+  }
+
+  Json scalar_dom() {
+    Json out{};
+    switch (token_) {
+      case Token::value_integer: out = lexer_.get_number_integer(); break;
+      case Token::value_unsigned: out = lexer_.get_number_unsigned(); break;
+      case Token::value_float: out = checked_float(); break;
+      default: out = std::move(lexer_.get_string()); break;
+    }
+    pending_ = false;
+    advance();
+    return out;
+  }
+
+  Real checked_float() {
+    const Real value = lexer_.get_number_float();
+    if (!std::isfinite(value)) {
+      throw Json::out_of_range::create(
+        406, fmt::format("number overflow parsing '{}'", lexer_.get_token_string()), nullptr);
+    }
+    return value;
+  }
+
+  void expect_value(Token expected, std::string_view type) const {
+    if (token_ != expected) {
+      type_error(type);
+    }
+  }
+
+  // Mirrors the `type_error`s thrown when converting a DOM value to the wrong type.
+  [[noreturn]] void type_error(std::string_view expected) const {
+    const char* actual = nullptr;
+    switch (token_) {
+      case Token::literal_null: actual = "null"; break;
+      case Token::literal_true:
+      case Token::literal_false: actual = "boolean"; break;
+      case Token::value_integer:
+      case Token::value_unsigned:
+      case Token::value_float: actual = "number"; break;
+      case Token::value_string: actual = "string"; break;
+      case Token::begin_object: actual = "object"; break;
+      case Token::begin_array: actual = "array"; break;
+      default: value_error();
+    }
+    throw Json::type_error::create(302, fmt::format("type must be {}, but is {}", expected, actual),
+                                   nullptr);
+  }
+
+  [[noreturn]] void value_error() const {
+    syntax_error(token_ == Token::parse_error ? Token::uninitialized : Token::literal_or_value,
+                 "value");
+  }
+
+  // Produces the same messages as the parser of `nlohmann::json`.
+  [[noreturn]] void syntax_error(Token expected, std::string_view context) const {
+    std::string msg = fmt::format("syntax error while parsing {} - ", context);
+    if (token_ == Token::parse_error) {
+      msg += fmt::format("{}; last read: '{}'", lexer_.get_error_message(),
+                         lexer_.get_token_string());
+    } else {
+      msg += fmt::format("unexpected {}", Lexer::token_type_name(token_));
+    }
+    if (expected != Token::uninitialized) {
+      msg += fmt::format("; expected {}", Lexer::token_type_name(expected));
+    }
+    throw Json::parse_error::create(101, lexer_.get_position(), msg, nullptr);
+  }
+
+  Lexer lexer_;
+  Token token_{Token::uninitialized};
+  std::string buffer_{};
+  std::size_t max_depth_;
+  std::vector<Container> containers_{};
+  bool first_{false};
+  // Whether the next token is the beginning of a value which has not been read yet
+  bool pending_{true};
+};
+
+template<typename TInput>
+inline auto json_reader(TInput&& input, std::size_t max_depth = default_max_depth) {
+  using Adapter = decltype(nlohmann::detail::input_adapter(std::forward<TInput>(input)));
+  return JsonReader<Adapter>{nlohmann::detail::input_adapter(std::forward<TInput>(input)),
+                             max_depth};
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_READER_HPP
@@ -7,13 +7,23 @@
 #ifndef INCLUDE_JAYBIRD_SERIALIZATION_SERIALIZATION_HPP
 #define INCLUDE_JAYBIRD_SERIALIZATION_SERIALIZATION_HPP
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <exception>
+#include <expected>
+#include <functional>
+#include <iterator>
 #include <optional>
+#include <ranges>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -28,6 +38,11 @@
 #include "thesauros/utility.hpp"
 
 #include "jaybird/base.hpp"
+#include "jaybird/base/decision-tree.hpp"
+#include "jaybird/base/perfect-hash.hpp"
+#include "jaybird/serialization/floating.hpp"
+#include "jaybird/serialization/reader.hpp"
+#include "jaybird/serialization/writer.hpp"
 
 namespace jay {
 template<typename T>
@@ -37,19 +52,258 @@ concept HasJsonConverter = thes::CompleteType<JsonConverter<T>>;
 
 template<JsonCompatible T>
 inline Json to_json(const T& value) {
-  return value;
+  if constexpr (std::same_as<T, float>) {
+    return detail::widen_float(value);
+  } else {
+    return value;
+  }
 }
 
 template<JsonCompatible T>
 inline T from_json(const Json& value) {
   return value.get<T>();
 }
+// Decodes a DOM which is not needed anymore, moving strings, arrays, and objects out of it
+// wherever the converter supports this.
+template<JsonCompatible T>
+inline T from_json(Json&& value) {
+  if constexpr (std::same_as<T, Json>) {
+    return std::move(value);
+  } else if constexpr (std::same_as<T, std::string>) {
+    if (value.is_string()) {
+      return std::move(value.get_ref<std::string&>());
+    }
+    return value.get<T>();
+  } else if constexpr (requires { JsonConverter<T>::from(std::move(value)); }) {
+    return JsonConverter<T>::from(std::move(value));
+  } else {
+    return value.get<T>();
+  }
+}
+
+// Converts a number like `Json::get` without dispatching through its serializer.
+template<typename T>
+requires(std::is_arithmetic_v<T> && !std::same_as<T, bool>)
+inline std::optional<T> get_number(const Json& json) {
+  auto convert = []<typename TValue>(TValue value) -> T {
+    if constexpr (std::same_as<TValue, T>) {
+      return value;
+    } else {
+      return static_cast<T>(value);
+    }
+  };
+  switch (json.type()) {
+    case Json::value_t::number_integer: return convert(*json.get_ptr<const Int*>());
+    case Json::value_t::number_unsigned: return convert(*json.get_ptr<const UInt*>());
+    case Json::value_t::number_float: return convert(*json.get_ptr<const Real*>());
+    case Json::value_t::boolean: return convert(*json.get_ptr<const bool*>());
+    default: return std::nullopt;
+  }
+}
+
+// Converts an element of a container, taking a shortcut for numbers.
+template<typename T, typename TJson>
+requires std::same_as<std::remove_cvref_t<TJson>, Json>
+inline T from_element(TJson&& json) {
+  if constexpr (std::is_arithmetic_v<T> && !std::same_as<T, bool>) {
+    if (const auto value = get_number<T>(json); value.has_value()) {
+      return *value;
+    }
+  }
+  return from_json<T>(std::forward<TJson>(json));
+}
+
+template<typename TWriter, typename T>
+constexpr void write_value(TWriter& writer, const T& value) {
+  if constexpr (requires { JsonConverter<T>::write(writer, value); }) {
+    JsonConverter<T>::write(writer, value);
+  } else if constexpr (requires { writer.dom(); } && BasicJson<T>) {
+    writer.dom();
+  } else if constexpr (BasicJson<T>) {
+    write_dom(writer, value);
+  } else if constexpr (std::same_as<T, bool>) {
+    writer.boolean(value);
+  } else if constexpr (std::signed_integral<T>) {
+    writer.integer(value);
+  } else if constexpr (std::unsigned_integral<T>) {
+    writer.unsigned_integer(value);
+  } else if constexpr (std::same_as<T, float>) {
+    // Writers with `floating32`, e.g. the binary writers, receive the `float` itself,
+    // whereas all others receive the same double as the DOM produced by `to_json`
+    if constexpr (requires { writer.floating32(value); }) {
+      writer.floating32(value);
+    } else {
+      writer.floating(detail::widen_float(value));
+    }
+  } else if constexpr (std::floating_point<T>) {
+    writer.floating(static_cast<Real>(value));
+  } else if constexpr (std::convertible_to<const T&, std::string_view>) {
+    writer.string(value);
+  } else if constexpr (requires { writer.dom(); }) {
+    writer.dom();
+  } else {
+    write_dom(writer, to_json(value));
+  }
+}
+
+namespace detail {
+// Whether the value returned by a lambda without captures can be rendered at compile time,
+// see `RenderCheck`.
+template<typename TMake>
+consteval bool is_renderable(TMake /*make*/) {
+  RenderCheck check{};
+  write_value(check, TMake{}());
+  return check.renderable;
+}
+} // namespace detail
+
+template<typename T, typename TReader>
+inline T read_value(TReader& reader) {
+  if constexpr (requires { JsonConverter<T>::read(reader); }) {
+    return JsonConverter<T>::read(reader);
+  } else if constexpr (std::same_as<T, Json>) {
+    return reader.dom();
+  } else if constexpr (std::same_as<T, bool>) {
+    return reader.boolean();
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    return reader.template number<T>();
+  } else if constexpr (std::same_as<T, std::string>) {
+    return reader.string();
+  } else {
+    return from_json<T>(reader.dom());
+  }
+}
+
+namespace detail {
+// Called in a `catch` block while reading from `reader`: If the exception is caused by a value
+// which cannot be decoded, the rest of the value is skipped until `depth` arrays and objects are
+// open, so that reading can continue. Other exceptions, i.e. syntax errors, failed allocations,
+// and programming errors (e.g. a missing `InternScope`), are rethrown.
+template<typename TReader>
+inline void recover_from_decode_error(TReader& reader, std::size_t depth) {
+  try {
+    throw;
+  } catch (const Json::parse_error& /*ex*/) {
+    throw;
+  } catch (const Json::exception& /*ex*/) {
+  } catch (const std::runtime_error& /*ex*/) {
+  } catch (const std::invalid_argument& /*ex*/) {
+  } catch (const std::length_error& /*ex*/) {
+  }
+  reader.recover(depth);
+}
+
+// Reads a complete document. A value which cannot be decoded is reported after the rest
+// of the document has been read, so that syntax errors take precedence like in the DOM-based
+// path, which parses the whole document first.
+template<typename T, typename TReader>
+inline T read_document(TReader& reader) {
+  try {
+    T value = read_value<T>(reader);
+    reader.finish();
+    return value;
+  } catch (...) {
+    recover_from_decode_error(reader, 0);
+    reader.finish();
+    throw;
+  }
+}
+} // namespace detail
+
+// An error which occurred when decoding a value, together with a JSON pointer (RFC 6901) to the
+// value which could not be decoded, relative to the value passed to the decoder.
+struct DecodeError {
+  explicit DecodeError(std::string message) : message_{std::move(message)} {}
+
+  // The error that `Json::get` produces for a value of the wrong type.
+  static DecodeError type_mismatch(std::string_view expected, const Json& json) {
+    return DecodeError{
+      Json::type_error::create(
+        302, fmt::format("type must be {}, but is {}", expected, json.type_name()), nullptr)
+        .what()};
+  }
+
+  [[nodiscard]] const char* what() const noexcept {
+    return message_.c_str();
+  }
+  [[nodiscard]] const std::string& pointer() const noexcept {
+    return pointer_;
+  }
+
+  // Prepends a reference token to the pointer when the error is passed to the enclosing value.
+  DecodeError&& at(std::string_view key) && {
+    std::string token{"/"};
+    for (const char c : key) {
+      switch (c) {
+        case '~': token += "~0"; break;
+        case '/': token += "~1"; break;
+        default: token += c; break;
+      }
+    }
+    pointer_.insert(0, token);
+    return std::move(*this);
+  }
+  DecodeError&& at(std::size_t index) && {
+    pointer_.insert(0, fmt::format("/{}", index));
+    return std::move(*this);
+  }
+
+private:
+  std::string message_;
+  std::string pointer_{};
+};
+template<typename T>
+using DecodeResult = std::expected<T, DecodeError>;
+
+// Decodes a value without throwing if it cannot be decoded, using `JsonConverter<T>::try_from`
+// if it exists. Types which are neither scalars nor have a converter fall back to `from_json`.
+template<typename T>
+inline DecodeResult<T> try_from_json(const Json& json) {
+  if constexpr (requires { JsonConverter<T>::try_from(json); }) {
+    return JsonConverter<T>::try_from(json);
+  } else if constexpr (std::same_as<T, Json>) {
+    return json;
+  } else if constexpr (std::same_as<T, bool>) {
+    if (!json.is_boolean()) {
+      return std::unexpected{DecodeError::type_mismatch("boolean", json)};
+    }
+    return json.get<bool>();
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    if (const auto value = get_number<T>(json); value.has_value()) {
+      return *value;
+    }
+    return std::unexpected{DecodeError::type_mismatch("number", json)};
+  } else if constexpr (std::same_as<T, std::string>) {
+    if (!json.is_string()) {
+      return std::unexpected{DecodeError::type_mismatch("string", json)};
+    }
+    return json.get_ref<const std::string&>();
+  } else {
+    try {
+      return from_json<T>(json);
+    } catch (const std::exception& ex) {
+      return std::unexpected{DecodeError{ex.what()}};
+    }
+  }
+}
 
 template<typename T>
 struct JsonFetcher {
   static T fetch(const Json& value, const std::string& key) {
     return from_json<T>(value.at(key));
   }
+  static T fetch(Json&& value, const std::string& key) {
+    return from_json<T>(std::move(value.at(key)));
+  }
+
+  // Called when `key` is not present in a streamed object.
+  [[noreturn]] static T missing(std::string_view key) {
+    throw Json::out_of_range::create(403, fmt::format("key '{}' not found", key), nullptr);
+  }
+  static DecodeResult<T> try_missing(std::string_view key) {
+    return std::unexpected{DecodeError{
+      Json::out_of_range::create(403, fmt::format("key '{}' not found", key), nullptr).what()}};
+  }
 };
 template<typename T>
 struct JsonFetcher<std::optional<T>> {
@@ -60,11 +314,29 @@ struct JsonFetcher<std::optional<T>> {
     }
     return from_json<std::optional<T>>(*it);
   }
+  static std::optional<T> fetch(Json&& value, const std::string& key) {
+    auto it = value.find(key);
+    if (it == value.end()) {
+      return std::nullopt;
+    }
+    return from_json<std::optional<T>>(std::move(*it));
+  }
+
+  static std::optional<T> missing(std::string_view /*key*/) {
+    return std::nullopt;
+  }
+  static DecodeResult<std::optional<T>> try_missing(std::string_view /*key*/) {
+    return std::nullopt;
+  }
 };
 template<typename T>
 inline T json_fetch(const Json& value, const std::string& key) {
   return JsonFetcher<T>::fetch(value, key);
 }
+template<typename T>
+inline T json_fetch(Json&& value, const std::string& key) {
+  return JsonFetcher<T>::fetch(std::move(value), key);
+}
 
 template<HasJsonMembers T>
 struct JsonConverter<T> {
@@ -75,6 +347,9 @@ struct JsonConverter<T> {
   static T from(const Json& json) {
     return T::from_json(json);
   }
+  static T from(Json&& json) {
+    return T::from_json(std::move(json));
+  }
 };
 
 struct StaticError final {
@@ -100,12 +375,10 @@ inline std::optional<StaticError> static_check(const Json& json) {
   if constexpr (requires { JsonConverter<T>::static_check(json); }) {
     return JsonConverter<T>::static_check(json);
   } else {
-    try {
-      json.get<T>();
-      return std::nullopt;
-    } catch (const std::exception& ex) {
-      return StaticError{ex.what()};
+    if (auto value = try_from_json<T>(json); !value.has_value()) {
+      return StaticError{value.error().what()};
     }
+    return std::nullopt;
   }
 }
 
@@ -113,37 +386,122 @@ template<HasTypeInfo T>
 struct JsonConverter<T> {
   using Info = thes::TypeInfo<T>;
 
+  struct Slot {
+    std::string_view key;
+    bool is_static;
+    std::size_t index;
+  };
+  static constexpr std::size_t static_size = std::tuple_size_v<decltype(Info::static_members)>;
+  static constexpr std::size_t member_size = std::tuple_size_v<decltype(Info::members)>;
+
+  // The keys in the order used by `Json::dump`, i.e. sorted, where a later key replaces an earlier
+  // one with the same name as in `to`.
+  static constexpr auto all_slots = [] {
+    std::array<Slot, static_size + member_size> out{};
+    [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      ((out[tIdxs] = {thes::star::get_at<tIdxs>(Info::static_members).serial_name.view(), true,
+                      tIdxs}),
+       ...);
+    }(std::make_index_sequence<static_size>{});
+    [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      ((out[static_size + tIdxs] = {thes::star::get_at<tIdxs>(Info::members).serial_name.view(),
+                                    false, tIdxs}),
+       ...);
+    }(std::make_index_sequence<member_size>{});
+    // Ties are broken by insertion order so that the last slot of each key is the one to keep
+    std::sort(out.begin(), out.end(), [](const Slot& a, const Slot& b) {
+      if (a.key != b.key) {
+        return a.key < b.key;
+      }
+      return std::pair{!a.is_static, a.index} < std::pair{!b.is_static, b.index};
+    });
+
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+      if (i + 1 < out.size() && out[i].key == out[i + 1].key) {
+        continue;
+      }
+      out[size++] = out[i];
+    }
+    return std::pair{out, size};
+  }();
+  static constexpr auto slots = [] {
+    std::array<Slot, all_slots.second> out{};
+    std::copy_n(all_slots.first.begin(), out.size(), out.begin());
+    return out;
+  }();
+  // Maps each distinct key to its index in `slots`, which is used to dispatch object entries.
+  static constexpr auto key_hash = [] {
+    std::array<std::string_view, slots.size()> keys{};
+    std::transform(slots.begin(), slots.end(), keys.begin(),
+                   [](const Slot& slot) { return slot.key; });
+    return PerfectHash{keys};
+  }();
+  // Whether each member has its own key, i.e. whether each entry is used by at most one member.
+  static constexpr bool has_distinct_keys = [] {
+    std::array<bool, slots.size()> used{};
+    return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return (... && !std::exchange(
+                       used[*key_hash.find(
+                         thes::star::get_at<tIdxs>(Info::members).serial_name.view())],
+                       true));
+    }(std::make_index_sequence<member_size>{});
+  }();
+
+  static constexpr auto static_keys = [] {
+    return Info::static_members | thes::star::apply([](const auto&... members) {
+             return std::array<std::string_view, static_size>{members.serial_name.view()...};
+           });
+  }();
+
+  // The serialized values of the static members, which are only computed on first use.
+  // `float`s are widened like by `to_json`.
+  static const std::array<Json, static_size>& static_values() {
+    static const auto values = Info::static_members | thes::star::apply([](const auto&... members) {
+                                 return std::array<Json, static_size>{
+                                   static_value(thes::serial_value(members.value))...};
+                               });
+    return values;
+  }
+
+  // Checks the values of the static members without throwing, where a value which is not an
+  // object or a missing key produce the same errors as the lookups in `from`.
+  static DecodeResult<void> try_static_check(const Json& json) {
+    if constexpr (static_size > 0) {
+      if (!json.is_object()) {
+        return std::unexpected{non_object_error(json)};
+      }
+    }
+    const auto& ref_values = static_values();
+    for (std::size_t i = 0; i < static_size; ++i) {
+      const auto it = json.find(static_keys[i]);
+      if (it == json.end()) {
+        return std::unexpected{JsonFetcher<Json>::try_missing(static_keys[i]).error()};
+      }
+      if (*it != ref_values[i]) {
+        const StaticError err{static_keys[i], *it, ref_values[i]};
+        return std::unexpected{DecodeError{err.what()}.at(static_keys[i])};
+      }
+    }
+    return {};
+  }
   static std::optional<StaticError> static_check(const Json& json) {
-    if constexpr (std::tuple_size_v<decltype(Info::static_members)> == 0) {
-      return std::nullopt;
-    } else {
-      return Info::static_members | thes::star::apply([&](const auto&... members) {
-               auto impl = [&](auto& rec, const auto& head,
-                               const auto&... tail) -> std::optional<StaticError> {
-                 const auto key = head.serial_name.view();
-                 const Json& value = json.at(key);
-                 const Json ref_value = thes::serial_value(head.value);
-                 if (value != ref_value) {
-                   return StaticError{key, value, ref_value};
-                 }
-                 if constexpr (sizeof...(tail) > 0) {
-                   return rec(rec, tail...);
-                 } else {
-                   return std::nullopt;
-                 }
-               };
-               return impl(impl, members...);
-             });
+    if (const auto checked = try_static_check(json); !checked.has_value()) {
+      return StaticError{checked.error().what()};
     }
+    return std::nullopt;
   }
 
   static Json to(const T& value) {
+    [[maybe_unused]] auto probe = type_probe(Operation::encode);
     auto json = Json::object();
 
-    auto static_member_impl = [&]<typename... TMembers>(TMembers... /*members*/) {
-      ((json[TMembers::serial_name.view()] = thes::serial_value(TMembers::value)), ...);
-    };
-    Info::static_members | thes::star::apply(static_member_impl);
+    if constexpr (static_size > 0) {
+      const auto& values = static_values();
+      for (std::size_t i = 0; i < static_size; ++i) {
+        json[static_keys[i]] = values[i];
+      }
+    }
 
     auto member_impl = [&]<typename... TMembers>(TMembers... /*members*/) {
       ((json[TMembers::serial_name.view()] = to_json(value.*TMembers::pointer)), ...);
@@ -153,56 +511,503 @@ struct JsonConverter<T> {
     return json;
   }
 
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, const T& value) {
+    [[maybe_unused]] auto probe = type_probe(Operation::encode);
+    writer.begin_object(slots.size());
+    [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      (write_slot<tIdxs>(writer, value), ...);
+    }(std::make_index_sequence<slots.size()>{});
+    writer.end_object();
+  }
+
   static T from(const Json& json) {
-    if (const auto err = static_check(json); err.has_value()) {
-      throw err->exception();
+    [[maybe_unused]] auto probe = type_probe(Operation::decode);
+    check_statics(json);
+    return from_members(json);
+  }
+  static T from(Json&& json) {
+    [[maybe_unused]] auto probe = type_probe(Operation::decode);
+    check_statics(json);
+    return from_members(std::move(json));
+  }
+  static DecodeResult<T> try_from(const Json& json) {
+    auto probe = type_probe(Operation::decode);
+    if (auto checked = try_static_check(json); !checked.has_value()) {
+      probe.fail();
+      return std::unexpected{std::move(checked.error())};
     }
-    return Info::members | thes::star::apply([&]<typename... TMembers>(TMembers... /*members*/) {
-             return T(json_fetch<typename TMembers::Type>(
-               json, std::string{TMembers::serial_name.view()})...);
-           });
+    auto out = try_from_members(json);
+    if (!out.has_value()) {
+      probe.fail();
+    }
+    return out;
+  }
+
+  // Reads the members without checking the static members.
+  // Entries are assigned to members in a single pass over the object using `key_hash`.
+  // The members are decoded in declaration order, so the first member which cannot be decoded
+  // is reported, as in `try_from_members` and `read`.
+  static T from_members(const Json& json) {
+    if (!json.is_object()) {
+      // Produce the same results and errors as a lookup of each member
+      return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+        std::tuple<typename MemberAt<tIdxs>::Type...> values{
+          json_fetch<typename MemberAt<tIdxs>::Type>(
+            json, std::string{MemberAt<tIdxs>::serial_name.view()})...};
+        return T(std::get<tIdxs>(std::move(values))...);
+      }(std::make_index_sequence<member_size>{});
+    }
+    return from_entries(json.get_ref<const Json::object_t&>());
+  }
+  // The entries are moved into the members unless several members share a key.
+  static T from_members(Json&& json) {
+    if (!json.is_object() || !has_distinct_keys) {
+      return from_members(std::as_const(json));
+    }
+    return from_entries(json.get_ref<Json::object_t&>());
+  }
+
+  static DecodeResult<T> try_from_members(const Json& json) {
+    std::array<const Json*, slots.size()> entries{};
+    if (json.is_object()) {
+      for (const auto& [key, value] : json.get_ref<const Json::object_t&>()) {
+        if (const auto idx = key_hash.find(key); idx.has_value()) {
+          entries[*idx] = &value;
+        }
+      }
+    }
+    return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) -> DecodeResult<T> {
+      std::tuple<std::optional<typename MemberAt<tIdxs>::Type>...> values{};
+      std::optional<DecodeError> error{};
+      (((error = try_fetch_entry<tIdxs>(entries, std::get<tIdxs>(values))).has_value()) || ...);
+      if (error.has_value()) {
+        // Without an object, a required member fails like the lookup in `from_members`
+        return std::unexpected{json.is_object() ? std::move(*error) : non_object_error(json)};
+      }
+      return T(take<tIdxs>(values)...);
+    }(std::make_index_sequence<member_size>{});
+  }
+
+  // Reads the members in document order and constructs the value once the object is complete.
+  // Errors are reported in the same order as in `from`: first the static members, then the
+  // members in declaration order, each of which is either missing or cannot be decoded.
+  template<typename TReader>
+  static T read(TReader& reader) {
+    auto probe = type_probe(Operation::decode);
+    [[maybe_unused]] const detail::ReadBytes bytes{reader, probe};
+    return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      std::tuple<std::optional<typename MemberAt<tIdxs>::Type>...> values{};
+      std::array<std::optional<Json>, static_size> statics{};
+      // The error of the last entry with each key, as later duplicates replace earlier ones
+      std::array<std::exception_ptr, slots.size()> errors{};
+
+      reader.begin_object();
+      const std::size_t depth = reader.depth();
+      while (const auto key = reader.key()) {
+        const auto idx = key_hash.find(*key);
+        if (!idx.has_value()) {
+          reader.skip();
+          continue;
+        }
+        errors[*idx] = nullptr;
+        try {
+          read_entry(reader, *idx, values, statics);
+        } catch (...) {
+          detail::recover_from_decode_error(reader, depth);
+          errors[*idx] = std::current_exception();
+        }
+      }
+
+      for (std::size_t i = 0; i < static_size; ++i) {
+        check_static(i, statics[i]);
+      }
+      (ensure_member<tIdxs>(values, errors), ...);
+      return T(take<tIdxs>(values)...);
+    }(std::make_index_sequence<member_size>{});
+  }
+
+private:
+  template<std::size_t tIdx>
+  using MemberAt = std::tuple_element_t<tIdx, std::decay_t<decltype(Info::members)>>;
+  template<std::size_t tIdx>
+  using StaticAt = std::tuple_element_t<tIdx, std::decay_t<decltype(Info::static_members)>>;
+
+  static constexpr std::size_t key_of(std::string_view key) {
+    return *key_hash.find(key);
+  }
+
+  static constexpr auto type_probe(Operation op) {
+    return detail::probe(op, [] { return Info::serial_name.view(); });
+  }
+
+  static void check_statics(const Json& json) {
+    const auto& ref_values = static_values();
+    for (std::size_t i = 0; i < static_size; ++i) {
+      if (const Json& value = json.at(static_keys[i]); value != ref_values[i]) {
+        throw StaticError{static_keys[i], value, ref_values[i]}.exception();
+      }
+    }
+  }
+
+  // Converts the entries of an object, which are moved from if the object is mutable.
+  template<typename TObject>
+  static T from_entries(TObject& obj) {
+    using Entry = std::conditional_t<std::is_const_v<TObject>, const Json, Json>;
+    std::array<Entry*, slots.size()> entries{};
+    for (auto& [key, value] : obj) {
+      if (const auto idx = key_hash.find(key); idx.has_value()) {
+        entries[*idx] = &value;
+      }
+    }
+    return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      // Unlike the arguments of a constructor call, braced initializers are evaluated in order
+      std::tuple<typename MemberAt<tIdxs>::Type...> values{fetch_entry<tIdxs>(entries)...};
+      return T(std::get<tIdxs>(std::move(values))...);
+    }(std::make_index_sequence<member_size>{});
+  }
+
+  template<std::size_t tIdx, typename TEntries>
+  static auto fetch_entry(const TEntries& entries) {
+    using Member = MemberAt<tIdx>;
+    using Type = typename Member::Type;
+    auto* entry = entries[key_of(Member::serial_name.view())];
+    if (entry == nullptr) {
+      return JsonFetcher<Type>::missing(Member::serial_name.view());
+    }
+    if constexpr (std::is_const_v<std::remove_pointer_t<decltype(entry)>>) {
+      return from_json<Type>(*entry);
+    } else {
+      return from_json<Type>(std::move(*entry));
+    }
+  }
+
+  template<std::size_t tIdx, typename TEntries, typename TValue>
+  static std::optional<DecodeError> try_fetch_entry(const TEntries& entries, TValue& out) {
+    using Member = MemberAt<tIdx>;
+    using Type = typename Member::Type;
+    const auto key = Member::serial_name.view();
+    const Json* entry = entries[key_of(key)];
+    if (entry == nullptr) {
+      auto value = JsonFetcher<Type>::try_missing(key);
+      if (!value.has_value()) {
+        return std::move(value.error());
+      }
+      out.emplace(std::move(*value));
+    } else {
+      auto value = try_from_json<Type>(*entry);
+      if (!value.has_value()) {
+        return std::move(value.error()).at(key);
+      }
+      out.emplace(std::move(*value));
+    }
+    return std::nullopt;
+  }
+
+  // The error produced by `Json::at` for a value which is not an object
+  static DecodeError non_object_error(const Json& json) {
+    return DecodeError{
+      Json::type_error::create(304, fmt::format("cannot use at() with {}", json.type_name()),
+                               nullptr)
+        .what()};
+  }
+
+  template<typename TReader, typename TValues, typename TStatics>
+  static void read_entry(TReader& reader, std::size_t idx, TValues& values, TStatics& statics) {
+    using Fun = void (*)(TReader&, TValues&, TStatics&);
+    static constexpr auto readers = []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return std::array<Fun, sizeof...(tIdxs)>{
+        &read_slot<tIdxs, TReader, TValues, TStatics>...};
+    }(std::make_index_sequence<slots.size()>{});
+
+    readers[idx](reader, values, statics);
   }
+
+  // Reads the value of the key `slots[tKey]` into all static members and members with that key.
+  // A lone member is read directly, whereas static members are compared as DOM values.
+  template<std::size_t tKey, typename TReader, typename TValues, typename TStatics>
+  static void read_slot(TReader& reader, TValues& values, TStatics& statics) {
+    static constexpr std::string_view key = slots[tKey].key;
+    static constexpr std::size_t static_num =
+      []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+        return (std::size_t{0} + ... + std::size_t{StaticAt<tIdxs>::serial_name.view() == key});
+      }(std::make_index_sequence<static_size>{});
+    static constexpr std::size_t member_num =
+      []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+        return (std::size_t{0} + ... + std::size_t{MemberAt<tIdxs>::serial_name.view() == key});
+      }(std::make_index_sequence<member_size>{});
+
+    // A later entry with the same key replaces the values of an earlier one
+    [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      (
+        [&] {
+          if constexpr (MemberAt<tIdxs>::serial_name.view() == key) {
+            std::get<tIdxs>(values).reset();
+          }
+        }(),
+        ...);
+    }(std::make_index_sequence<member_size>{});
+
+    if constexpr (static_num == 0 && member_num == 1) {
+      [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+        (
+          [&] {
+            if constexpr (MemberAt<tIdxs>::serial_name.view() == key) {
+              std::get<tIdxs>(values).emplace(read_value<typename MemberAt<tIdxs>::Type>(reader));
+            }
+          }(),
+          ...);
+      }(std::make_index_sequence<member_size>{});
+    } else {
+      const Json json = reader.dom();
+      [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+        (
+          [&] {
+            if constexpr (StaticAt<tIdxs>::serial_name.view() == key) {
+              statics[tIdxs].emplace(json);
+            }
+          }(),
+          ...);
+      }(std::make_index_sequence<static_size>{});
+      [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+        (
+          [&] {
+            if constexpr (MemberAt<tIdxs>::serial_name.view() == key) {
+              std::get<tIdxs>(values).emplace(from_json<typename MemberAt<tIdxs>::Type>(json));
+            }
+          }(),
+          ...);
+      }(std::make_index_sequence<member_size>{});
+    }
+  }
+
+  // Fails with the error of the member's entry, or with that of a missing member.
+  template<std::size_t tIdx, typename TValues, typename TErrors>
+  static void ensure_member(TValues& values, const TErrors& errors) {
+    using Member = MemberAt<tIdx>;
+    using Type = typename Member::Type;
+    auto& value = std::get<tIdx>(values);
+    if (value.has_value()) {
+      return;
+    }
+    if (const auto& error = errors[key_of(Member::serial_name.view())]; error != nullptr) {
+      std::rethrow_exception(error);
+    }
+    value.emplace(JsonFetcher<Type>::missing(Member::serial_name.view()));
+  }
+
+  template<std::size_t tIdx, typename TValues>
+  static auto take(TValues& values) {
+    using Type = typename MemberAt<tIdx>::Type;
+    return Type(std::move(*std::get<tIdx>(values)));
+  }
+
+  template<typename TValue>
+  static Json static_value(const TValue& value) {
+    if constexpr (std::same_as<TValue, float>) {
+      return detail::widen_float(value);
+    } else {
+      return Json(value);
+    }
+  }
+
+  static void check_static(std::size_t idx, const std::optional<Json>& value) {
+    if (!value.has_value()) {
+      JsonFetcher<Json>::missing(static_keys[idx]);
+    }
+    if (const Json& ref_value = static_values()[idx]; *value != ref_value) {
+      throw StaticError{static_keys[idx], *value, ref_value}.exception();
+    }
+  }
+
+  template<std::size_t tIdx, typename TWriter>
+  static constexpr void write_slot(TWriter& writer, const T& value) {
+    constexpr Slot slot = slots[tIdx];
+    if constexpr (requires { writer.rendered_key(std::string_view{}); }) {
+      writer.rendered_key(rendered_key<tIdx>.view());
+    } else {
+      writer.key(slot.key);
+    }
+    if constexpr (slot.is_static) {
+      write_static<slot.index>(writer);
+    } else {
+      write_value(writer, value.*MemberAt<slot.index>::pointer);
+    }
+  }
+  template<std::size_t tIdx, typename TWriter>
+  static constexpr void write_static(TWriter& writer) {
+    constexpr bool renderable =
+      detail::is_renderable([] { return thes::serial_value(StaticAt<tIdx>::value); });
+    if constexpr (renderable && requires { writer.rendered_value(std::string_view{}); }) {
+      // Objects and arrays would need to be indented
+      constexpr std::string_view text = rendered_static<tIdx>.view();
+      if constexpr (text.front() != '{' && text.front() != '[') {
+        writer.rendered_value(text);
+        return;
+      }
+    }
+    write_value(writer, thes::serial_value(StaticAt<tIdx>::value));
+  }
+
+  // The keys as `"key":` and the static members as compact JSON text, which are rendered at
+  // compile time so that writing them only copies the text.
+  template<std::size_t tIdx>
+  static constexpr auto rendered_key = detail::static_text([] {
+    std::string out{};
+    ContainerSink sink{out};
+    JsonWriter{sink}.string(slots[tIdx].key);
+    out.push_back(':');
+    return out;
+  });
+  template<std::size_t tIdx>
+  static constexpr auto rendered_static = detail::static_text([] {
+    std::string out{};
+    ContainerSink sink{out};
+    JsonWriter writer{sink};
+    write_value(writer, thes::serial_value(StaticAt<tIdx>::value));
+    return out;
+  });
 };
 
 template<HasEnumInfo T>
 struct JsonConverter<T> {
   using EnumInfo = thes::EnumInfo<T>;
 
-  static Json to(const T& value) {
-    auto impl = [&]<std::size_t tHead, std::size_t... tTail>(
-                  auto rec, std::index_sequence<tHead, tTail...>) THES_ALWAYS_INLINE -> Json {
-      constexpr auto value_info = thes::star::get_at<tHead>(EnumInfo::values);
-      if (value_info.value == value) {
-        return value_info.serial_name.view();
-      }
-      if constexpr (sizeof...(tTail) > 0) {
-        return rec(rec, std::index_sequence<tTail...>{});
-      } else {
-        throw std::invalid_argument{
-          fmt::format("The value {} is not a valid value for the enum {}!",
-                      static_cast<std::underlying_type_t<T>>(value), EnumInfo::name.view())};
+  using Underlying = std::underlying_type_t<T>;
+  static constexpr std::size_t value_num = std::tuple_size_v<decltype(EnumInfo::values)>;
+
+  static constexpr auto values = [] {
+    return EnumInfo::values | thes::star::apply([](const auto&... infos) {
+             return std::array<T, value_num>{infos.value...};
+           });
+  }();
+  static constexpr auto names = [] {
+    return EnumInfo::values | thes::star::apply([](const auto&... infos) {
+             return std::array<std::string_view, value_num>{infos.serial_name.view()...};
+           });
+  }();
+  static constexpr PerfectHash name_hash{names};
+
+  // The offset of a value from the smallest value, which is well-defined for any underlying type
+  static constexpr std::uint64_t offset_of(Underlying value) {
+    return static_cast<std::uint64_t>(value) - static_cast<std::uint64_t>(min_value);
+  }
+  static constexpr Underlying min_value = [] {
+    Underlying out{};
+    for (std::size_t i = 0; i < value_num; ++i) {
+      const auto value = static_cast<Underlying>(values[i]);
+      out = (i == 0 || value < out) ? value : out;
+    }
+    return out;
+  }();
+  static constexpr std::uint64_t max_offset = [] {
+    std::uint64_t out = 0;
+    for (const T value : values) {
+      out = std::max(out, offset_of(static_cast<Underlying>(value)));
+    }
+    return out;
+  }();
+  // Dense enums use a table indexed by `offset_of`, which contains the index of the first entry
+  // with each value or `value_num` if there is none.
+  // Other enums use the entries sorted by value and a binary search.
+  static constexpr bool is_dense = max_offset < 2 * value_num + 8;
+  static constexpr auto value_table = [] {
+    if constexpr (is_dense) {
+      std::array<std::size_t, max_offset + 1> out{};
+      out.fill(value_num);
+      for (std::size_t i = value_num; i > 0; --i) {
+        out[offset_of(static_cast<Underlying>(values[i - 1]))] = i - 1;
       }
-    };
-    return impl(impl, std::make_index_sequence<std::tuple_size_v<decltype(EnumInfo::values)>>{});
+      return out;
+    } else {
+      std::array<std::size_t, value_num> out{};
+      for (std::size_t i = 0; i < value_num; ++i) {
+        out[i] = i;
+      }
+      std::sort(out.begin(), out.end(), [](std::size_t a, std::size_t b) {
+        const auto va = static_cast<Underlying>(values[a]);
+        const auto vb = static_cast<Underlying>(values[b]);
+        return va < vb || (va == vb && a < b);
+      });
+      return out;
+    }
+  }();
+
+  static constexpr std::string_view serial_name(const T& value) {
+    const auto underlying = static_cast<Underlying>(value);
+    if constexpr (is_dense) {
+      if (const auto offset = offset_of(underlying); offset <= max_offset) {
+        if (const std::size_t idx = value_table[offset]; idx < value_num) {
+          return names[idx];
+        }
+      }
+    } else {
+      const auto it = std::lower_bound(
+        value_table.begin(), value_table.end(), underlying,
+        [](std::size_t idx, Underlying v) { return static_cast<Underlying>(values[idx]) < v; });
+      if (it != value_table.end() && values[*it] == value) {
+        return names[*it];
+      }
+    }
+    throw std::invalid_argument{fmt::format("The value {} is not a valid value for the enum {}!",
+                                            underlying, EnumInfo::name.view())};
+  }
+
+  static Json to(const T& value) {
+    [[maybe_unused]] auto probe = type_probe(Operation::encode);
+    return serial_name(value);
+  }
+
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, const T& value) {
+    [[maybe_unused]] auto probe = type_probe(Operation::encode);
+    writer.string(serial_name(value));
+  }
+
+  static T from_serial_name(std::string_view value) {
+    if (const auto idx = name_hash.find(value); idx.has_value()) {
+      return values[*idx];
+    }
+    throw std::invalid_argument{unknown_name_msg(value)};
   }
 
   static T from(const Json& json) {
-    const std::string& value = json.get<std::string>();
+    [[maybe_unused]] auto probe = type_probe(Operation::decode);
+    if (const auto* str = json.get_ptr<const std::string*>(); str != nullptr) {
+      return from_serial_name(*str);
+    }
+    // Throws the same error as a conversion to `std::string`
+    return from_serial_name(json.get<std::string>());
+  }
 
-    auto impl = [&]<std::size_t tHead, std::size_t... tTail>(
-                  auto rec, std::index_sequence<tHead, tTail...>) THES_ALWAYS_INLINE -> T {
-      constexpr auto value_info = thes::star::get_at<tHead>(EnumInfo::values);
-      if (value_info.serial_name.view() == value) {
-        return value_info.value;
-      }
-      if constexpr (sizeof...(tTail) > 0) {
-        return rec(rec, std::index_sequence<tTail...>{});
-      } else {
-        throw std::invalid_argument{fmt::format(
-          "The value {} is not a valid value for the enum {}!", value, EnumInfo::name.view())};
-      }
-    };
-    return impl(impl, std::make_index_sequence<std::tuple_size_v<decltype(EnumInfo::values)>>{});
+  static DecodeResult<T> try_from(const Json& json) {
+    auto probe = type_probe(Operation::decode);
+    const auto* str = json.get_ptr<const std::string*>();
+    if (str == nullptr) {
+      probe.fail();
+      return std::unexpected{DecodeError::type_mismatch("string", json)};
+    }
+    if (const auto idx = name_hash.find(*str); idx.has_value()) {
+      return values[*idx];
+    }
+    probe.fail();
+    return std::unexpected{DecodeError{unknown_name_msg(*str)}};
+  }
+
+  template<typename TReader>
+  static T read(TReader& reader) {
+    auto probe = type_probe(Operation::decode);
+    [[maybe_unused]] const detail::ReadBytes bytes{reader, probe};
+    return from_serial_name(reader.string_view());
+  }
+
+private:
+  static constexpr auto type_probe(Operation op) {
+    return detail::probe(op, [] { return EnumInfo::name.view(); });
+  }
+  static std::string unknown_name_msg(std::string_view value) {
+    return fmt::format("The value {} is not a valid value for the enum {}!", value,
+                       EnumInfo::name.view());
   }
 };
 
@@ -215,12 +1020,42 @@ struct JsonConverter<std::optional<T>> {
     return {};
   }
 
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, const std::optional<T>& value) {
+    if (value.has_value()) {
+      write_value(writer, *value);
+    } else {
+      writer.null();
+    }
+  }
+
   static std::optional<T> from(const Json& json) {
     if (json.is_null()) {
       return std::nullopt;
     }
     return from_json<T>(json);
   }
+  static std::optional<T> from(Json&& json) {
+    if (json.is_null()) {
+      return std::nullopt;
+    }
+    return from_json<T>(std::move(json));
+  }
+  static DecodeResult<std::optional<T>> try_from(const Json& json) {
+    if (json.is_null()) {
+      return std::nullopt;
+    }
+    return try_from_json<T>(json);
+  }
+
+  template<typename TReader>
+  static std::optional<T> read(TReader& reader) {
+    if (reader.is_null()) {
+      reader.null();
+      return std::nullopt;
+    }
+    return read_value<T>(reader);
+  }
 };
 
 template<typename... Ts>
@@ -248,34 +1083,200 @@ struct JsonConverter<std::variant<Ts...>> {
       value);
   }
 
-  static Var from(const Json& json) {
-    if (json.size() != 1) {
-      throw std::invalid_argument("A variant JSON needs to be an object with a single entry!");
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, const Var& value) {
+    std::visit(
+      [&]<typename T>(const T& var) {
+        writer.begin_object(1);
+        writer.key(thes::serial_name_of<T>().view());
+        write_value(writer, var);
+        writer.end_object();
+      },
+      value);
+  }
+
+  static Var from(const Json& json) {
+    if (json.size() != 1) {
+      throw std::invalid_argument("A variant JSON needs to be an object with a single entry!");
+    }
+    auto it = json.begin();
+    return from_entry(it.key(), it.value());
+  }
+  static Var from(Json&& json) {
+    if (json.size() != 1) {
+      throw std::invalid_argument("A variant JSON needs to be an object with a single entry!");
+    }
+    auto it = json.begin();
+    return from_entry(it.key(), std::move(it.value()));
+  }
+  static DecodeResult<Var> try_from(const Json& json) {
+    if (!json.is_object() || json.size() != 1) {
+      return std::unexpected{
+        DecodeError{"A variant JSON needs to be an object with a single entry!"}};
     }
     auto it = json.begin();
-    const auto& key = it.key();
-    const auto& value = it.value();
-
     std::vector<StaticError> errors{};
-    auto impl = [&]<typename THead, typename... TTail>(auto rec, const THead& /*head*/,
-                                                       const TTail&... tail) -> Var {
-      using Type = typename THead::Type;
+    const std::size_t idx = select(it.key(), it.value(), errors);
+    if (idx == size) {
+      return std::unexpected{DecodeError{error_msg(errors)}};
+    }
+
+    using Fun = DecodeResult<Var> (*)(const Json&);
+    static constexpr auto try_froms = []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return std::array<Fun, sizeof...(tIdxs)>{&try_from_alternative<tIdxs>...};
+    }(std::index_sequence_for<Ts...>{});
+    auto out = try_froms[idx](it.value());
+    if (!out.has_value()) {
+      return std::unexpected{std::move(out.error()).at(it.key())};
+    }
+    return out;
+  }
+
+  // An alternative is read by `read_alternative` if it is the only one with the given name.
+  // Otherwise, the alternatives have to be checked against the value, which is read into a DOM.
+  template<typename TReader>
+  static Var read(TReader& reader) {
+    reader.begin_object();
+    const auto key = reader.key();
+    if (!key.has_value()) {
+      throw std::invalid_argument("A variant JSON needs to be an object with a single entry!");
+    }
+
+    const auto name_idx = name_hash.find(*key);
+    const bool is_unique =
+      name_idx.has_value() && candidate_begins[*name_idx + 1] - candidate_begins[*name_idx] == 1;
+    Var out = [&] {
+      if (!is_unique) {
+        const std::string key_str{*key};
+        return from_entry(key_str, reader.dom());
+      }
+      using Fun = Var (*)(TReader&);
+      static constexpr auto readers = []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+        return std::array<Fun, sizeof...(tIdxs)>{&read_alternative<tIdxs, TReader>...};
+      }(std::index_sequence_for<Ts...>{});
+      return readers[candidates[candidate_begins[*name_idx]]](reader);
+    }();
+
+    if (reader.key().has_value()) {
+      throw std::invalid_argument("A variant JSON needs to be an object with a single entry!");
+    }
+    return out;
+  }
+
+private:
+  static constexpr std::size_t size = sizeof...(Ts);
+  static constexpr std::array<std::string_view, size> names{thes::serial_name_of<Ts>().view()...};
 
-      if (thes::serial_name_of<Type>().view() == key) {
-        if (auto err = static_check<Type>(value); err.has_value()) {
+  // The distinct names in the order of their first occurrence.
+  static constexpr auto distinct_names = [] {
+    std::array<std::string_view, size> out{};
+    std::size_t num = 0;
+    for (const std::string_view alt_name : names) {
+      if (std::find(out.begin(), out.begin() + num, alt_name) == out.begin() + num) {
+        out[num++] = alt_name;
+      }
+    }
+    return std::pair{out, num};
+  }();
+  static constexpr auto name_hash = [] {
+    std::array<std::string_view, distinct_names.second> keys{};
+    std::copy_n(distinct_names.first.begin(), keys.size(), keys.begin());
+    return PerfectHash{keys};
+  }();
+  // The indices of the alternatives grouped by name, where the alternatives with the name
+  // `name_hash.keys()[i]` are `candidates[candidate_begins[i]]` to
+  // `candidates[candidate_begins[i + 1] - 1]` in declaration order.
+  static constexpr auto candidate_begins = [] {
+    std::array<std::size_t, name_hash.keys().size() + 1> out{};
+    for (const std::string_view alt_name : names) {
+      ++out[*name_hash.find(alt_name) + 1];
+    }
+    for (std::size_t i = 1; i < out.size(); ++i) {
+      out[i] += out[i - 1];
+    }
+    return out;
+  }();
+  static constexpr auto candidates = [] {
+    std::array<std::size_t, size> out{};
+    auto next = candidate_begins;
+    for (std::size_t i = 0; i < size; ++i) {
+      out[next[*name_hash.find(names[i])]++] = i;
+    }
+    return out;
+  }();
+
+  // Returns the first alternative with the name `key` whose static members match the value
+  // or `size` if there is none, collecting the errors of the other alternatives with that name.
+  static std::size_t select(std::string_view key, const Json& value,
+                            std::vector<StaticError>& errors) {
+    using Check = std::optional<StaticError> (*)(const Json&);
+    static constexpr std::array<Check, size> checks{&static_check<Ts>...};
+
+    if (const auto name_idx = name_hash.find(key); name_idx.has_value()) {
+      for (std::size_t i = candidate_begins[*name_idx]; i < candidate_begins[*name_idx + 1]; ++i) {
+        // TODO Always returns the first hit!
+        if (auto err = checks[candidates[i]](value); err.has_value()) {
           errors.push_back(std::move(*err));
         } else {
-          // TODO Always returns the first hit!
-          return from_json<Type>(value);
+          return candidates[i];
         }
       }
-      if constexpr (sizeof...(TTail) > 0) {
-        return rec(rec, tail...);
+    }
+    return size;
+  }
+
+  // The value is moved into the alternative if it is an rvalue.
+  template<typename TJson>
+  static Var from_entry(const std::string& key, TJson&& value) {
+    std::vector<StaticError> errors{};
+    const std::size_t idx = select(key, value, errors);
+    if (idx == size) {
+      throw std::invalid_argument{error_msg(errors)};
+    }
+
+    using Fun = Var (*)(TJson&&);
+    static constexpr auto froms = []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return std::array<Fun, sizeof...(tIdxs)>{&from_alternative<tIdxs, TJson>...};
+    }(std::index_sequence_for<Ts...>{});
+    return froms[idx](std::forward<TJson>(value));
+  }
+
+  template<std::size_t tIdx, typename TJson>
+  static Var from_alternative(TJson&& value) {
+    using Type = std::variant_alternative_t<tIdx, Var>;
+    return Var{std::in_place_index<tIdx>, from_json<Type>(std::forward<TJson>(value))};
+  }
+  template<std::size_t tIdx>
+  static DecodeResult<Var> try_from_alternative(const Json& value) {
+    using Type = std::variant_alternative_t<tIdx, Var>;
+    auto out = try_from_json<Type>(value);
+    if (!out.has_value()) {
+      return std::unexpected{std::move(out.error())};
+    }
+    return Var{std::in_place_index<tIdx>, std::move(*out)};
+  }
+
+  // Reads the only alternative with its name, which fails like `from_entry`: `select` checks
+  // the static members of described types, which are compared in a DOM, and decodes other types,
+  // whose errors are therefore reported as an unknown variant.
+  template<std::size_t tIdx, typename TReader>
+  static Var read_alternative(TReader& reader) {
+    using Type = std::variant_alternative_t<tIdx, Var>;
+    if constexpr (HasTypeInfo<Type>) {
+      if constexpr (JsonConverter<Type>::static_size == 0) {
+        return Var{std::in_place_index<tIdx>, read_value<Type>(reader)};
       } else {
-        throw std::invalid_argument{error_msg(errors)};
+        return from_entry(std::string{names[tIdx]}, reader.dom());
       }
-    };
-    return impl(impl, thes::type_tag<Ts>...);
+    } else {
+      const std::size_t depth = reader.depth();
+      try {
+        return Var{std::in_place_index<tIdx>, read_value<Type>(reader)};
+      } catch (const std::exception& ex) {
+        detail::recover_from_decode_error(reader, depth);
+        throw std::invalid_argument{error_msg({StaticError{ex.what()}})};
+      }
+    }
   }
 };
 
@@ -299,47 +1300,712 @@ struct JsonConverter<UniVariant<Ts...>> {
     return std::visit([]<typename T>(const T& var) { return to_json(var); }, value);
   }
 
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, const Var& value) {
+    std::visit([&](const auto& var) { write_value(writer, var); }, value);
+  }
+
+  // The alternatives are distinguished by their static members, so the value is checked as a DOM.
+  template<typename TReader>
+  static Var read(TReader& reader) {
+    return from(reader.dom());
+  }
+
   static Var from(const Json& json) {
+    return from_impl(json);
+  }
+  static Var from(Json&& json) {
+    return from_impl(std::move(json));
+  }
+  static DecodeResult<Var> try_from(const Json& json) {
     std::vector<StaticError> errors{};
-    auto impl = [&]<typename THead, typename... TTail>(auto rec, const THead& /*head*/,
-                                                       const TTail&... tail) -> Var {
-      using Type = typename THead::Type;
+    const std::size_t idx = find_alternative(json, errors);
+    if (idx == size) {
+      return std::unexpected{DecodeError{error_msg(errors)}};
+    }
 
-      if (auto err = static_check<Type>(json); err.has_value()) {
-        errors.push_back(std::move(*err));
-      } else {
-        // TODO Always returns the first hit!
-        return from_json<Type>(json);
+    using Fun = DecodeResult<Var> (*)(const Json&);
+    static constexpr auto try_froms = []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return std::array<Fun, sizeof...(tIdxs)>{&try_from_alternative<tIdxs>...};
+    }(std::index_sequence_for<Ts...>{});
+    return try_froms[idx](json);
+  }
+
+private:
+  static constexpr std::size_t size = sizeof...(Ts);
+  static constexpr std::size_t discriminant_num =
+    (std::size_t{0} + ... + JsonConverter<Ts>::static_size);
+
+  // The static members of all alternatives, which are used as discriminants.
+  template<typename T>
+  static constexpr auto static_members_of() {
+    using Members = std::decay_t<decltype(thes::TypeInfo<T>::static_members)>;
+    return []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return std::tuple<std::type_identity<std::tuple_element_t<tIdxs, Members>>...>{};
+    }(std::make_index_sequence<std::tuple_size_v<Members>>{});
+  }
+  using StaticMembers = decltype(std::tuple_cat(static_members_of<Ts>()...));
+  template<std::size_t tIdx>
+  using StaticAt = typename std::tuple_element_t<tIdx, StaticMembers>::type;
+
+  static constexpr auto static_keys = [] {
+    std::array<std::string_view, discriminant_num> out{};
+    auto it = out.begin();
+    ((it = std::copy(JsonConverter<Ts>::static_keys.begin(), JsonConverter<Ts>::static_keys.end(),
+                     it)),
+     ...);
+    return out;
+  }();
+  static constexpr auto distinct_keys = [] {
+    std::array<std::string_view, discriminant_num> out{};
+    std::size_t num = 0;
+    for (const std::string_view key : static_keys) {
+      if (std::find(out.begin(), out.begin() + num, key) == out.begin() + num) {
+        out[num++] = key;
+      }
+    }
+    return std::pair{out, num};
+  }();
+  static constexpr auto keys = [] {
+    std::array<std::string_view, distinct_keys.second> out{};
+    std::copy_n(distinct_keys.first.begin(), out.size(), out.begin());
+    return out;
+  }();
+
+  // Whether two static members with the same key have the same serialized value, which is
+  // decided using the serialized values if they are constant expressions and the values otherwise.
+  template<typename TA, typename TB>
+  static constexpr bool same_value() {
+    using A = std::remove_cvref_t<decltype(TA::value)>;
+    using B = std::remove_cvref_t<decltype(TB::value)>;
+    if constexpr (requires {
+                    typename std::bool_constant<(thes::serial_value(TA::value) ==
+                                                 thes::serial_value(TB::value))>;
+                  }) {
+      return thes::serial_value(TA::value) == thes::serial_value(TB::value);
+    } else if constexpr (std::equality_comparable_with<A, B>) {
+      return TA::value == TB::value;
+    } else {
+      return std::same_as<A, B> && std::is_empty_v<A>;
+    }
+  }
+  template<std::size_t tIdx, std::size_t tOther>
+  static constexpr bool same_discriminant() {
+    if constexpr (static_keys[tIdx] == static_keys[tOther]) {
+      return same_value<StaticAt<tIdx>, StaticAt<tOther>>();
+    } else {
+      return false;
+    }
+  }
+  // The index of the first static member with the same key and value
+  template<std::size_t tIdx>
+  static constexpr std::size_t value_class() {
+    const auto same = []<std::size_t... tOthers>(std::index_sequence<tOthers...>) {
+      return std::array<bool, tIdx + 1>{same_discriminant<tIdx, tOthers>()..., true};
+    }(std::make_index_sequence<tIdx>{});
+    return static_cast<std::size_t>(std::find(same.begin(), same.end(), true) - same.begin());
+  }
+  static constexpr auto discriminants = [] {
+    constexpr std::array<std::size_t, size> static_sizes{JsonConverter<Ts>::static_size...};
+    constexpr auto value_classes = []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return std::array<std::size_t, discriminant_num>{value_class<tIdxs>()...};
+    }(std::make_index_sequence<discriminant_num>{});
+
+    std::array<Discriminant, discriminant_num> out{};
+    std::size_t i = 0;
+    for (std::size_t alt = 0; alt < size; ++alt) {
+      for (std::size_t j = 0; j < static_sizes[alt]; ++j, ++i) {
+        const auto key = std::find(keys.begin(), keys.end(), static_keys[i]) - keys.begin();
+        out[i] = {alt, static_cast<std::size_t>(key), value_classes[i]};
+      }
+    }
+    return out;
+  }();
+  static_assert(!find_ambiguity(size, discriminants).has_value(),
+                "The alternatives of a UniVariant need to have a static member in common "
+                "whose values differ!");
+  static constexpr auto tree =
+    make_decision_tree<[] { return std::tuple{size, keys.size(), discriminants}; }>();
+
+  // The serialized values of the discriminants.
+  static const std::array<const Json*, discriminant_num>& discriminant_values() {
+    static const auto values = [] {
+      std::array<const Json*, discriminant_num> out{};
+      auto it = out.begin();
+      ((it = std::transform(JsonConverter<Ts>::static_values().begin(),
+                            JsonConverter<Ts>::static_values().end(), it,
+                            [](const Json& value) { return &value; })),
+       ...);
+      return out;
+    }();
+    return values;
+  }
+
+  // Returns the index of the only alternative whose static members match or `size` if there is
+  // none, looking up each key at most once.
+  static std::size_t select(const Json& json) {
+    const auto& values = discriminant_values();
+    const DecisionNode* node = &tree.nodes[0];
+    while (node->key != DecisionNode::leaf) {
+      std::size_t next = node->next;
+      if (const auto it = json.find(keys[node->key]); it != json.end()) {
+        for (std::size_t i = node->begin; i < node->end; ++i) {
+          if (*it == *values[tree.branches[i].discriminant]) {
+            next = tree.branches[i].node;
+            break;
+          }
+        }
+      }
+      node = &tree.nodes[next];
+    }
+    for (std::size_t i = node->begin; i < node->end; ++i) {
+      const std::size_t idx = tree.checks[i];
+      const auto it = json.find(keys[discriminants[idx].key]);
+      if (it == json.end() || *it != *values[idx]) {
+        return size;
+      }
+    }
+    return node->next;
+  }
+
+  // The alternative is selected by a decision tree over the values of the static members.
+  // If no alternative matches, each one is checked to report the errors.
+  static std::size_t find_alternative(const Json& json, std::vector<StaticError>& errors) {
+    if (json.is_object()) {
+      if (const std::size_t idx = select(json); idx < size) {
+        return idx;
       }
+    }
 
-      if constexpr (sizeof...(TTail) > 0) {
-        return rec(rec, tail...);
+    using Check = std::optional<StaticError> (*)(const Json&);
+    static constexpr std::array<Check, size> checks{&static_check<Ts>...};
+    for (std::size_t i = 0; i < size; ++i) {
+      if (auto err = checks[i](json); err.has_value()) {
+        errors.push_back(std::move(*err));
       } else {
-        throw std::invalid_argument{error_msg(errors)};
+        return i;
       }
-    };
-    return impl(impl, thes::type_tag<Ts>...);
+    }
+    return size;
+  }
+
+  // The value is moved into the alternative if it is an rvalue.
+  template<typename TJson>
+  static Var from_impl(TJson&& json) {
+    std::vector<StaticError> errors{};
+    const std::size_t idx = find_alternative(json, errors);
+    if (idx == size) {
+      throw std::invalid_argument{error_msg(errors)};
+    }
+
+    using Fun = Var (*)(TJson&&);
+    static constexpr auto froms = []<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return std::array<Fun, sizeof...(tIdxs)>{&from_alternative<tIdxs, TJson>...};
+    }(std::index_sequence_for<Ts...>{});
+    return froms[idx](std::forward<TJson>(json));
+  }
+
+  template<std::size_t tIdx, typename TJson>
+  static Var from_alternative(TJson&& json) {
+    using Type = std::variant_alternative_t<tIdx, std::variant<Ts...>>;
+    return Var{std::in_place_index<tIdx>,
+               JsonConverter<Type>::from_members(std::forward<TJson>(json))};
+  }
+  template<std::size_t tIdx>
+  static DecodeResult<Var> try_from_alternative(const Json& json) {
+    using Type = std::variant_alternative_t<tIdx, std::variant<Ts...>>;
+    auto out = JsonConverter<Type>::try_from_members(json);
+    if (!out.has_value()) {
+      return std::unexpected{std::move(out.error())};
+    }
+    return Var{std::in_place_index<tIdx>, std::move(*out)};
   }
 };
 
+template<typename TRange>
+inline Json array_to_json(const TRange& range) {
+  auto out = Json::array();
+  auto& arr = out.get_ref<Json::array_t&>();
+  arr.reserve(std::size(range));
+  for (const auto& v : range) {
+    if constexpr (std::same_as<std::ranges::range_value_t<TRange>, float>) {
+      arr.emplace_back(detail::widen_float(v));
+    } else if constexpr (std::is_arithmetic_v<std::ranges::range_value_t<TRange>>) {
+      arr.emplace_back(v);
+    } else {
+      arr.push_back(to_json(v));
+    }
+  }
+  return out;
+}
+template<typename TWriter, typename TRange>
+constexpr void write_array(TWriter& writer, const TRange& range) {
+  writer.begin_array(std::size(range));
+  for (const auto& v : range) {
+    writer.element();
+    write_value(writer, v);
+  }
+  writer.end_array();
+}
+
+// Decodes the elements of an array in order and passes them to `sink`,
+// returning the first error with its index.
+template<typename T, typename TSink>
+inline std::optional<DecodeError> try_fill_array(const Json& json, TSink sink) {
+  const auto& arr = json.get_ref<const Json::array_t&>();
+  for (std::size_t i = 0; i < arr.size(); ++i) {
+    auto value = try_from_json<T>(arr[i]);
+    if (!value.has_value()) {
+      return std::move(value.error()).at(i);
+    }
+    sink(std::move(*value));
+  }
+  return std::nullopt;
+}
+
 template<JsonCompatible T, std::size_t tCapacity>
 struct JsonConverter<thes::LimitedArray<T, tCapacity>> {
   using Arr = thes::LimitedArray<T, tCapacity>;
 
   static Json to(const Arr& arr) {
-    auto out = Json::array();
-    for (const auto& v : arr) {
-      out.push_back(to_json(v));
-    }
-    return out;
+    return array_to_json(arr);
+  }
+
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, const Arr& arr) {
+    write_array(writer, arr);
   }
 
   static Arr from(const Json& json) {
     assert(json.size() <= tCapacity);
-    auto trans = thes::transform_range([](auto v) { return from_json<T>(v); }, json);
-    return Arr{trans.begin(), trans.end()};
+    Arr arr{};
+    for (const Json& v : json) {
+      arr.push_back(from_element<T>(v));
+    }
+    return arr;
+  }
+  static Arr from(Json&& json) {
+    assert(json.size() <= tCapacity);
+    Arr arr{};
+    for (Json& v : json) {
+      arr.push_back(from_element<T>(std::move(v)));
+    }
+    return arr;
+  }
+
+  static DecodeResult<Arr> try_from(const Json& json) {
+    if (!json.is_array()) {
+      return std::unexpected{DecodeError::type_mismatch("array", json)};
+    }
+    if (json.size() > tCapacity) {
+      return std::unexpected{DecodeError{capacity_msg()}};
+    }
+    Arr arr{};
+    if (auto err = try_fill_array<T>(json, [&](T&& value) { arr.push_back(std::move(value)); });
+        err.has_value()) {
+      return std::unexpected{std::move(*err)};
+    }
+    return arr;
+  }
+
+  template<typename TReader>
+  static Arr read(TReader& reader) {
+    Arr arr{};
+    reader.begin_array();
+    while (reader.element()) {
+      if (arr.size() == tCapacity) {
+        throw std::length_error{capacity_msg()};
+      }
+      arr.push_back(read_value<T>(reader));
+    }
+    return arr;
+  }
+
+private:
+  static std::string capacity_msg() {
+    return fmt::format("A LimitedArray can hold at most {} values!", tCapacity);
+  }
+};
+
+// The elements are converted in place into a vector with the exact size.
+template<JsonCompatible T, typename TAlloc>
+requires(!std::same_as<T, Json>)
+struct JsonConverter<std::vector<T, TAlloc>> {
+  using Vec = std::vector<T, TAlloc>;
+
+  static Json to(const Vec& vec) {
+    return array_to_json(vec);
+  }
+
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, const Vec& vec) {
+    write_array(writer, vec);
+  }
+
+  static Vec from(const Json& json) {
+    if (!json.is_array()) {
+      throw Json::type_error::create(
+        302, fmt::format("type must be array, but is {}", json.type_name()), nullptr);
+    }
+    const auto& arr = json.get_ref<const Json::array_t&>();
+    Vec vec{};
+    vec.reserve(arr.size());
+    for (const Json& v : arr) {
+      vec.push_back(from_element<T>(v));
+    }
+    return vec;
+  }
+  static Vec from(Json&& json) {
+    if (!json.is_array()) {
+      return from(std::as_const(json));
+    }
+    auto& arr = json.get_ref<Json::array_t&>();
+    Vec vec{};
+    vec.reserve(arr.size());
+    for (Json& v : arr) {
+      vec.push_back(from_element<T>(std::move(v)));
+    }
+    return vec;
+  }
+
+  static DecodeResult<Vec> try_from(const Json& json) {
+    if (!json.is_array()) {
+      return std::unexpected{DecodeError::type_mismatch("array", json)};
+    }
+    Vec vec{};
+    vec.reserve(json.size());
+    if (auto err = try_fill_array<T>(json, [&](T&& value) { vec.push_back(std::move(value)); });
+        err.has_value()) {
+      return std::unexpected{std::move(*err)};
+    }
+    return vec;
+  }
+
+  template<typename TReader>
+  static Vec read(TReader& reader) {
+    Vec vec{};
+    reader.begin_array();
+    while (reader.element()) {
+      vec.push_back(read_value<T>(reader));
+    }
+    return vec;
   }
 };
+
+// Like `Json::get`, missing elements are an error, whereas additional elements are ignored.
+template<JsonCompatible T, std::size_t tSize>
+struct JsonConverter<std::array<T, tSize>> {
+  using Arr = std::array<T, tSize>;
+
+  static Json to(const Arr& arr) {
+    return array_to_json(arr);
+  }
+
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, const Arr& arr) {
+    write_array(writer, arr);
+  }
+
+  static Arr from(const Json& json) {
+    if (!json.is_array()) {
+      throw Json::type_error::create(
+        302, fmt::format("type must be array, but is {}", json.type_name()), nullptr);
+    }
+    const auto& arr = json.get_ref<const Json::array_t&>();
+    if (arr.size() < tSize) {
+      throw out_of_range_error(arr.size());
+    }
+    return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return Arr{from_element<T>(arr[tIdxs])...};
+    }(std::make_index_sequence<tSize>{});
+  }
+  static Arr from(Json&& json) {
+    if (!json.is_array() || json.size() < tSize) {
+      return from(std::as_const(json));
+    }
+    auto& arr = json.get_ref<Json::array_t&>();
+    return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return Arr{from_element<T>(std::move(arr[tIdxs]))...};
+    }(std::make_index_sequence<tSize>{});
+  }
+
+  static DecodeResult<Arr> try_from(const Json& json) {
+    if (!json.is_array()) {
+      return std::unexpected{DecodeError::type_mismatch("array", json)};
+    }
+    const auto& arr = json.get_ref<const Json::array_t&>();
+    if (arr.size() < tSize) {
+      return std::unexpected{DecodeError{out_of_range_error(arr.size()).what()}};
+    }
+    std::array<std::optional<T>, tSize> values{};
+    for (std::size_t i = 0; i < tSize; ++i) {
+      auto value = try_from_json<T>(arr[i]);
+      if (!value.has_value()) {
+        return std::unexpected{std::move(value.error()).at(i)};
+      }
+      values[i].emplace(std::move(*value));
+    }
+    return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return Arr{std::move(*values[tIdxs])...};
+    }(std::make_index_sequence<tSize>{});
+  }
+
+  template<typename TReader>
+  static Arr read(TReader& reader) {
+    std::array<std::optional<T>, tSize> values{};
+    std::size_t size = 0;
+    reader.begin_array();
+    while (reader.element()) {
+      if (size < tSize) {
+        values[size++].emplace(read_value<T>(reader));
+      } else {
+        reader.skip();
+      }
+    }
+    if (size < tSize) {
+      throw out_of_range_error(size);
+    }
+    return [&]<std::size_t... tIdxs>(std::index_sequence<tIdxs...>) {
+      return Arr{std::move(*values[tIdxs])...};
+    }(std::make_index_sequence<tSize>{});
+  }
+
+private:
+  static Json::out_of_range out_of_range_error(std::size_t index) {
+    return Json::out_of_range::create(401, fmt::format("array index {} is out of range", index),
+                                      nullptr);
+  }
+};
+
+// Strings are stored in the current intern pool when decoding.
+template<>
+struct JsonConverter<InternedString> {
+  static Json to(InternedString value) {
+    return Json(value.view());
+  }
+
+  template<typename TWriter>
+  static constexpr void write(TWriter& writer, InternedString value) {
+    writer.string(value.view());
+  }
+
+  static InternedString from(const Json& json) {
+    if (!json.is_string()) {
+      throw Json::type_error::create(
+        302, fmt::format("type must be string, but is {}", json.type_name()), nullptr);
+    }
+    return InternedString::intern(json.get_ref<const std::string&>());
+  }
+  static DecodeResult<InternedString> try_from(const Json& json) {
+    if (!json.is_string()) {
+      return std::unexpected{DecodeError::type_mismatch("string", json)};
+    }
+    return InternedString::intern(json.get_ref<const std::string&>());
+  }
+
+  // The string is only copied if it has not been interned before.
+  template<typename TReader>
+  static InternedString read(TReader& reader) {
+    return InternedString::intern(reader.string_view());
+  }
+};
+
+// Maps with string keys, e.g. `std::map`, `std::unordered_map`, or `ankerl::unordered_dense::map`.
+// The keys can also be `InternedString`s, which are stored in the current pool when decoding.
+template<typename T>
+concept StringMap = requires(T& map, typename T::key_type key) {
+  typename T::mapped_type;
+  requires std::same_as<typename T::key_type, std::string> ||
+             std::same_as<typename T::key_type, InternedString>;
+  map.insert_or_assign(std::move(key), std::declval<typename T::mapped_type>());
+};
+
+// Entries are written in the order of `Json::dump`, i.e. sorted by key, and a map is reserved
+// before inserting if it supports it.
+template<StringMap TMap>
+requires(JsonCompatible<typename TMap::mapped_type> &&
+         !std::same_as<typename TMap::mapped_type, Json>)
+struct JsonConverter<TMap> {
+  using Key = typename TMap::key_type;
+  using Value = typename TMap::mapped_type;
+
+  static Json to(const TMap& map) {
+    auto out = Json::object();
+    auto& obj = out.get_ref<Json::object_t&>();
+    for (const auto& [key, value] : map) {
+      if constexpr (std::same_as<Key, std::string>) {
+        obj.insert_or_assign(key, to_json(value));
+      } else {
+        obj.insert_or_assign(std::string{key.view()}, to_json(value));
+      }
+    }
+    return out;
+  }
+
+  template<typename TWriter>
+  static void write(TWriter& writer, const TMap& map) {
+    writer.begin_object(map.size());
+    if constexpr (is_sorted) {
+      for (const auto& [key, value] : map) {
+        writer.key(key);
+        write_value(writer, value);
+      }
+    } else {
+      std::vector<const typename TMap::value_type*> entries{};
+      entries.reserve(map.size());
+      for (const auto& entry : map) {
+        entries.push_back(&entry);
+      }
+      std::sort(entries.begin(), entries.end(),
+                [](const auto* a, const auto* b) { return a->first < b->first; });
+      for (const auto* entry : entries) {
+        writer.key(entry->first);
+        write_value(writer, entry->second);
+      }
+    }
+    writer.end_object();
+  }
+
+  static TMap from(const Json& json) {
+    if (!json.is_object()) {
+      throw Json::type_error::create(
+        302, fmt::format("type must be object, but is {}", json.type_name()), nullptr);
+    }
+    const auto& obj = json.get_ref<const Json::object_t&>();
+    TMap map{};
+    reserve(map, obj.size());
+    for (const auto& [key, value] : obj) {
+      map.insert_or_assign(make_key(key), from_element<Value>(value));
+    }
+    return map;
+  }
+  // The keys are moved as well by extracting the entries of the object.
+  static TMap from(Json&& json) {
+    if (!json.is_object()) {
+      return from(std::as_const(json));
+    }
+    auto& obj = json.get_ref<Json::object_t&>();
+    TMap map{};
+    reserve(map, obj.size());
+    while (!obj.empty()) {
+      auto entry = obj.extract(obj.begin());
+      map.insert_or_assign(make_key(std::move(entry.key())),
+                           from_element<Value>(std::move(entry.mapped())));
+    }
+    return map;
+  }
+
+  static DecodeResult<TMap> try_from(const Json& json) {
+    if (!json.is_object()) {
+      return std::unexpected{DecodeError::type_mismatch("object", json)};
+    }
+    const auto& obj = json.get_ref<const Json::object_t&>();
+    TMap map{};
+    reserve(map, obj.size());
+    for (const auto& [key, value] : obj) {
+      auto decoded = try_from_json<Value>(value);
+      if (!decoded.has_value()) {
+        return std::unexpected{std::move(decoded.error()).at(key)};
+      }
+      map.insert_or_assign(make_key(key), std::move(*decoded));
+    }
+    return map;
+  }
+
+  // As in `Json::parse`, the last entry with a given key is kept.
+  template<typename TReader>
+  static TMap read(TReader& reader) {
+    TMap map{};
+    reader.begin_object();
+    while (const auto key = reader.key()) {
+      Key key_value = make_key(*key);
+      map.insert_or_assign(std::move(key_value), read_value<Value>(reader));
+    }
+    return map;
+  }
+
+private:
+  static constexpr bool is_sorted = requires {
+    typename TMap::key_compare;
+    requires std::same_as<typename TMap::key_compare, std::less<Key>> ||
+               std::same_as<typename TMap::key_compare, std::less<>>;
+  };
+
+  template<typename TKey>
+  static Key make_key(TKey&& key) {
+    if constexpr (std::same_as<Key, InternedString>) {
+      return InternedString::intern(key);
+    } else {
+      return Key{std::forward<TKey>(key)};
+    }
+  }
+
+  static void reserve(TMap& map, std::size_t size) {
+    if constexpr (requires { map.reserve(size); }) {
+      map.reserve(size);
+    }
+  }
+};
+
+// Writes the JSON text of `value` without building a DOM, producing the same output as
+// `to_json(value).dump(indent)`.
+template<typename TSink, typename T>
+requires JsonSink<TSink>
+constexpr void write_json(TSink& sink, const T& value, int indent = -1) {
+  JsonWriter writer{sink, indent};
+  write_value(writer, value);
+}
+template<typename TContainer, typename T>
+requires requires(TContainer& c, const char* ptr) {
+  c.push_back('0');
+  c.append(ptr, ptr);
+}
+constexpr void write_json(TContainer& container, const T& value, int indent = -1) {
+  ContainerSink sink{container};
+  write_json(sink, value, indent);
+}
+template<std::output_iterator<char> TIt, typename T>
+inline TIt write_json(TIt it, const T& value, int indent = -1) {
+  IteratorSink sink{std::move(it)};
+  write_json(sink, value, indent);
+  return sink.iterator();
+}
+template<typename T>
+inline void write_json(std::FILE* handle, const T& value, int indent = -1) {
+  FileSink sink{handle};
+  write_json(sink, value, indent);
+  sink.flush();
+}
+template<typename T>
+constexpr std::string to_json_string(const T& value, int indent = -1) {
+  std::string out{};
+  write_json(out, value, indent);
+  return out;
+}
+
+// Renders a value at compile time, which produces the same text as `to_json_string`.
+// `make` is a lambda without captures which returns the value, e.g.
+// `static_dump([] { return Test5{5}; })`.
+// Values containing floating-point numbers or types which are converted through a DOM
+// cannot be rendered, which is rejected by a `static_assert`.
+template<typename TMake>
+consteval auto static_dump(TMake /*make*/) {
+  constexpr bool renderable = detail::is_renderable(TMake{});
+  static_assert(renderable,
+                "static_dump cannot render floating-point numbers or types without a writer");
+  if constexpr (renderable) {
+    return detail::static_text([] { return to_json_string(TMake{}()); });
+  }
+}
+
+// Parses JSON text directly into a `T` without building a DOM for the whole document.
+// Errors are the same as those of `from_json<T>(Json::parse(input))`, except that arrays and
+// objects nested more than `default_max_depth` levels deep are rejected with a `parse_error`.
+template<typename T>
+inline T parse(std::string_view input) {
+  auto reader = json_reader(input);
+  return detail::read_document<T>(reader);
+}
 } // namespace jay
 
 namespace nlohmann {
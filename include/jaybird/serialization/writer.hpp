@@ -0,0 +1,462 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#ifndef INCLUDE_JAYBIRD_SERIALIZATION_WRITER_HPP
+#define INCLUDE_JAYBIRD_SERIALIZATION_WRITER_HPP
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "nlohmann/json.hpp"
+#include "thesauros/format.hpp"
+
+#include "jaybird/base/defs.hpp"
+
+namespace jay {
+// A sink receives the characters produced by a writer.
+template<typename T>
+concept JsonSink = requires(T& sink, char c, std::string_view str) {
+  sink.put(c);
+  sink.write(str);
+};
+
+// Appends to a contiguous character container, e.g. `std::string` or `fmt::memory_buffer`.
+template<typename TContainer>
+struct ContainerSink {
+  explicit constexpr ContainerSink(TContainer& container) : container_{container} {}
+
+  constexpr void put(char c) {
+    container_.push_back(c);
+  }
+  constexpr void write(std::string_view str) {
+    container_.append(str.data(), str.data() + str.size());
+  }
+
+private:
+  TContainer& container_;
+};
+
+template<std::output_iterator<char> TIt>
+struct IteratorSink {
+  explicit IteratorSink(TIt it) : it_{std::move(it)} {}
+
+  void put(char c) {
+    *it_ = c;
+    ++it_;
+  }
+  void write(std::string_view str) {
+    it_ = std::copy(str.begin(), str.end(), std::move(it_));
+  }
+
+  [[nodiscard]] TIt iterator() const {
+    return it_;
+  }
+
+private:
+  TIt it_;
+};
+
+// Collects the output in a fixed-size buffer which is handed to `fwrite` whenever it is full.
+struct FileSink {
+  static constexpr std::size_t capacity = 16384;
+
+  explicit FileSink(std::FILE* handle) : handle_{handle} {}
+  FileSink(const FileSink&) = delete;
+  FileSink& operator=(const FileSink&) = delete;
+  ~FileSink() {
+    if (size_ > 0) {
+      std::fwrite(buffer_.data(), 1, size_, handle_);
+    }
+  }
+
+  void put(char c) {
+    if (size_ == capacity) {
+      flush();
+    }
+    buffer_[size_++] = c;
+  }
+  void write(std::string_view str) {
+    if (str.size() > capacity - size_) {
+      flush();
+      if (str.size() > capacity) {
+        write_through(str);
+        return;
+      }
+    }
+    std::copy(str.begin(), str.end(), buffer_.data() + size_);
+    size_ += str.size();
+  }
+
+  void flush() {
+    write_through({buffer_.data(), std::exchange(size_, 0)});
+  }
+
+  [[nodiscard]] std::FILE* handle() const {
+    return handle_;
+  }
+
+private:
+  void write_through(std::string_view str) {
+    if (std::fwrite(str.data(), 1, str.size(), handle_) != str.size()) {
+      throw std::runtime_error{"Writing JSON to a file failed!"};
+    }
+  }
+
+  std::FILE* handle_;
+  std::array<char, capacity> buffer_{};
+  std::size_t size_{0};
+};
+
+// Emits JSON text with the same formatting as `Json::dump`.
+// Objects and arrays are written using `begin_*`/`end_*`, where each object member is introduced
+// by `key` and each array element by `element`.
+// Everything except floating-point numbers can be written in constant expressions.
+template<JsonSink TSink>
+struct JsonWriter {
+  // `depth` is the nesting depth of the written value, which determines its indentation.
+  explicit constexpr JsonWriter(TSink& sink, int indent = -1, std::size_t depth = 0)
+      : sink_{sink}, indent_{indent}, depth_{depth} {}
+
+  constexpr void null() {
+    sink_.write("null");
+  }
+  constexpr void boolean(bool value) {
+    sink_.write(value ? "true" : "false");
+  }
+  constexpr void integer(Int value) {
+    write_integer(value);
+  }
+  constexpr void unsigned_integer(UInt value) {
+    write_integer(value);
+  }
+  void floating(Real value) {
+    if (!std::isfinite(value)) {
+      null();
+      return;
+    }
+    std::array<char, 64> buffer{};
+    char* end = nlohmann::detail::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    sink_.write({buffer.data(), end});
+  }
+  constexpr void string(std::string_view str) {
+    sink_.put('"');
+    write_escaped(str);
+    sink_.put('"');
+  }
+
+  constexpr void begin_object(std::size_t /*size*/) {
+    open('{');
+  }
+  constexpr void key(std::string_view key) {
+    separate();
+    string(key);
+    if (indent_ >= 0) {
+      sink_.write(": ");
+    } else {
+      sink_.put(':');
+    }
+  }
+  constexpr void end_object() {
+    close('}');
+  }
+
+  constexpr void begin_array(std::size_t /*size*/) {
+    open('[');
+  }
+  constexpr void element() {
+    separate();
+  }
+  constexpr void end_array() {
+    close(']');
+  }
+
+  // Writes a key which has been rendered in advance in compact form, i.e. `"key":`.
+  constexpr void rendered_key(std::string_view text) {
+    separate();
+    sink_.write(text);
+    if (indent_ >= 0) {
+      sink_.put(' ');
+    }
+  }
+  // Writes a scalar value which has been rendered in advance.
+  constexpr void rendered_value(std::string_view text) {
+    sink_.write(text);
+  }
+
+private:
+  static constexpr std::string_view spaces = "                                ";
+  static constexpr std::string_view hex = "0123456789abcdef";
+
+  template<typename T>
+  constexpr void write_integer(T value) {
+    std::array<char, 24> buffer{};
+    char* const end = buffer.data() + buffer.size();
+    if consteval {
+      // `std::to_chars` cannot be used in constant expressions before GCC 13
+      using Unsigned = std::make_unsigned_t<T>;
+      auto magnitude = static_cast<Unsigned>(value);
+      if constexpr (std::signed_integral<T>) {
+        if (value < 0) {
+          magnitude = static_cast<Unsigned>(Unsigned{0} - magnitude);
+        }
+      }
+      char* ptr = end;
+      do {
+        *--ptr = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+      } while (magnitude != 0);
+      if constexpr (std::signed_integral<T>) {
+        if (value < 0) {
+          *--ptr = '-';
+        }
+      }
+      sink_.write({ptr, end});
+    } else {
+      const auto [ptr, ec] = std::to_chars(buffer.data(), end, value);
+      sink_.write({buffer.data(), ptr});
+    }
+  }
+
+  constexpr void open(char c) {
+    sink_.put(c);
+    ++depth_;
+    first_ = true;
+  }
+  constexpr void separate() {
+    if (!first_) {
+      sink_.put(',');
+    }
+    first_ = false;
+    if (indent_ >= 0) {
+      newline();
+    }
+  }
+  constexpr void close(char c) {
+    --depth_;
+    if (indent_ >= 0 && !first_) {
+      newline();
+    }
+    sink_.put(c);
+    first_ = false;
+  }
+  constexpr void newline() {
+    sink_.put('\n');
+    for (std::size_t n = static_cast<std::size_t>(indent_) * depth_; n > 0;) {
+      const auto chunk = std::min(n, spaces.size());
+      sink_.write(spaces.substr(0, chunk));
+      n -= chunk;
+    }
+  }
+
+  // Escapes like `Json::dump` with `ensure_ascii = false` and a strict error handler,
+  // i.e. UTF-8 is passed through after validation and invalid input throws `type_error` 316.
+  constexpr void write_escaped(std::string_view str) {
+    std::size_t run_begin = 0;
+    auto flush_run = [&](std::size_t end) {
+      if (end > run_begin) {
+        sink_.write(str.substr(run_begin, end - run_begin));
+      }
+    };
+
+    for (std::size_t i = 0; i < str.size();) {
+      const auto byte = static_cast<unsigned char>(str[i]);
+      if (byte >= 0x80) {
+        i = skip_utf8(str, i);
+        continue;
+      }
+      if (byte >= 0x20 && byte != '"' && byte != '\\') {
+        ++i;
+        continue;
+      }
+
+      flush_run(i);
+      switch (byte) {
+        case '\b': sink_.write("\\b"); break;
+        case '\t': sink_.write("\\t"); break;
+        case '\n': sink_.write("\\n"); break;
+        case '\f': sink_.write("\\f"); break;
+        case '\r': sink_.write("\\r"); break;
+        case '"': sink_.write("\\\""); break;
+        case '\\': sink_.write("\\\\"); break;
+        default: {
+          const std::array<char, 6> escaped{'\\', 'u', '0', '0', hex[byte >> 4U], hex[byte & 0xFU]};
+          sink_.write({escaped.data(), escaped.size()});
+          break;
+        }
+      }
+      run_begin = ++i;
+    }
+    flush_run(str.size());
+  }
+
+  // Returns the index after the UTF-8 sequence starting at `i`, rejecting the same bytes
+  // as the DFA used by `Json::dump`.
+  static constexpr std::size_t skip_utf8(std::string_view str, std::size_t i) {
+    const auto lead = static_cast<unsigned char>(str[i]);
+    std::size_t tail = 0;
+    unsigned char lower = 0x80;
+    unsigned char upper = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      tail = 1;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      tail = 2;
+      lower = lead == 0xE0 ? 0xA0 : 0x80;
+      upper = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      tail = 3;
+      lower = lead == 0xF0 ? 0x90 : 0x80;
+      upper = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+      throw_invalid_utf8(i, lead);
+    }
+
+    for (std::size_t j = 1; j <= tail; ++j) {
+      if (i + j == str.size()) {
+        throw Json::type_error::create(
+          316, fmt::format("incomplete UTF-8 string; last byte: 0x{:02X}", str.back() & 0xFF),
+          nullptr);
+      }
+      const auto byte = static_cast<unsigned char>(str[i + j]);
+      if (byte < lower || byte > upper) {
+        throw_invalid_utf8(i + j, byte);
+      }
+      lower = 0x80;
+      upper = 0xBF;
+    }
+    return i + tail + 1;
+  }
+
+  [[noreturn]] static void throw_invalid_utf8(std::size_t index, unsigned char byte) {
+    throw Json::type_error::create(
+      316, fmt::format("invalid UTF-8 byte at index {}: 0x{:02X}", index, byte), nullptr);
+  }
+
+  TSink& sink_;
+  int indent_;
+  std::size_t depth_{0};
+  bool first_{true};
+};
+
+// JSON text which has been rendered at compile time.
+template<std::size_t tSize>
+struct StaticText {
+  std::array<char, tSize> chars{};
+
+  [[nodiscard]] constexpr std::string_view view() const {
+    return {chars.data(), chars.size()};
+  }
+  constexpr operator std::string_view() const { // NOLINT
+    return view();
+  }
+};
+
+namespace detail {
+// Stores the string returned by a lambda without captures in a `StaticText`.
+template<typename TRender>
+consteval auto static_text(TRender /*render*/) {
+  constexpr std::size_t size = TRender{}().size();
+  StaticText<size> out{};
+  std::ranges::copy(TRender{}(), out.chars.begin());
+  return out;
+}
+
+// A writer which only records whether a value can be rendered at compile time, which is not
+// the case if it contains floating-point numbers or is converted through a DOM.
+struct RenderCheck {
+  bool renderable = true;
+
+  constexpr void null() {}
+  constexpr void boolean(bool /*value*/) {}
+  constexpr void integer(Int /*value*/) {}
+  constexpr void unsigned_integer(UInt /*value*/) {}
+  constexpr void floating(Real /*value*/) {
+    renderable = false;
+  }
+  constexpr void floating32(float /*value*/) {
+    renderable = false;
+  }
+  constexpr void string(std::string_view /*str*/) {}
+  constexpr void begin_object(std::size_t /*size*/) {}
+  constexpr void key(std::string_view /*key*/) {}
+  constexpr void end_object() {}
+  constexpr void begin_array(std::size_t /*size*/) {}
+  constexpr void element() {}
+  constexpr void end_array() {}
+  constexpr void dom() {
+    renderable = false;
+  }
+};
+} // namespace detail
+
+// Writes a DOM value through a writer, producing the same output as `Json::dump`.
+template<typename TWriter, BasicJson TJson>
+inline void write_dom(TWriter& writer, const TJson& json) {
+  using Value = typename TJson::value_t;
+  using String = typename TJson::string_t;
+  using Object = typename TJson::object_t;
+  using Array = typename TJson::array_t;
+  switch (json.type()) {
+    case Value::null: writer.null(); break;
+    case Value::boolean: writer.boolean(json.template get<bool>()); break;
+    case Value::number_integer: writer.integer(json.template get<Int>()); break;
+    case Value::number_unsigned: writer.unsigned_integer(json.template get<UInt>()); break;
+    case Value::number_float: writer.floating(json.template get<Real>()); break;
+    case Value::string: writer.string(json.template get_ref<const String&>()); break;
+    case Value::object: {
+      writer.begin_object(json.size());
+      for (const auto& [key, value] : json.template get_ref<const Object&>()) {
+        writer.key(key);
+        write_dom(writer, value);
+      }
+      writer.end_object();
+      break;
+    }
+    case Value::array: {
+      writer.begin_array(json.size());
+      for (const auto& value : json.template get_ref<const Array&>()) {
+        writer.element();
+        write_dom(writer, value);
+      }
+      writer.end_array();
+      break;
+    }
+    case Value::binary: {
+      const auto& binary = json.get_binary();
+      writer.begin_object(2);
+      writer.key("bytes");
+      writer.begin_array(binary.size());
+      for (const auto byte : binary) {
+        writer.element();
+        writer.unsigned_integer(byte);
+      }
+      writer.end_array();
+      writer.key("subtype");
+      if (binary.has_subtype()) {
+        writer.unsigned_integer(binary.subtype());
+      } else {
+        writer.null();
+      }
+      writer.end_object();
+      break;
+    }
+    case Value::discarded: writer.null(); break;
+  }
+}
+} // namespace jay
+
+#endif // INCLUDE_JAYBIRD_SERIALIZATION_WRITER_HPP
@@ -0,0 +1,90 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#define JAYBIRD_INSTRUMENTATION 1
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "thesauros/test.hpp"
+#include "thesauros/thesauros.hpp"
+
+#include "jaybird/jaybird.hpp"
+
+struct Test1 {
+  THES_DEFINE_TYPE(KEEP(Test1), CONSTEXPR_CONSTRUCTOR,
+                   MEMBERS((KEEP(a), float), (KEEP(b), (std::pair<float, int>)), (KEEP(c), int)))
+};
+struct TestTwo {
+  THES_DEFINE_TYPE(SNAKE_CASE(TestTwo), CONSTEXPR_CONSTRUCTOR,
+                   MEMBERS((KEEP(a), float, {}), (KEEP(b), Test1, (Test1{0.0, {2.0, 3}, 1})),
+                           (KEEP(c), int, {})))
+};
+THES_DEFINE_ENUM(SNAKE_CASE(Direction), bool, LOWERCASE(FORWARD), LOWERCASE(BACKWARD));
+
+int main() {
+  using jay::Json;
+  static_assert(jay::instrumentation_enabled);
+
+  const TestTwo value{1.5F, Test1{0.5F, {2.0F, 3}, 4}, 5};
+  const Json json = jay::to_json(value);
+  const std::string text = json.dump();
+  {
+    std::thread thread{[&] { THES_ASSERT(jay::to_json(value) == json); }};
+    thread.join();
+  }
+  THES_ASSERT(jay::to_json(jay::from_json<TestTwo>(json)) == json);
+  THES_ASSERT(jay::to_json(jay::parse<TestTwo>(text)) == json);
+
+  try {
+    jay::from_json<Direction>(Json("sideways"));
+    return 1;
+  } catch (const std::invalid_argument& /*ex*/) {
+  }
+  THES_ASSERT(!jay::try_from_json<Direction>(Json(1)).has_value());
+  THES_ASSERT(jay::from_json<Direction>(Json("forward")) == Direction::FORWARD);
+
+  const auto path = std::filesystem::temp_directory_path() / "jaybird-instrumentation-test.json";
+  {
+    std::ofstream out{path, std::ios::binary};
+    out << text;
+  }
+  THES_ASSERT(jay::to_json(jay::read_file<TestTwo>(path)) == json);
+  std::filesystem::remove(path);
+
+  {
+    // The counters of the thread which has exited are included
+    const jay::Statistics stats = jay::collect_statistics();
+    const jay::TypeStats& two = stats.at("test_two");
+    // Two encodings on different threads and one to check each of the three decodings
+    THES_ASSERT(two.encode.calls == 5 && two.encode.failures == 0 && two.encode.bytes == 0);
+    THES_ASSERT(two.decode.calls == 3 && two.decode.failures == 0);
+    // The streaming decoders count the consumed input
+    THES_ASSERT(two.decode.bytes == 2 * text.size());
+    THES_ASSERT(two.decode.nanoseconds >= stats.at("Test1").decode.nanoseconds);
+    THES_ASSERT(stats.at("Test1").encode.calls == 5 && stats.at("Test1").decode.calls == 3);
+
+    const jay::TypeStats& direction = stats.at("direction");
+    THES_ASSERT(direction.decode.calls == 3 && direction.decode.failures == 2);
+
+    const jay::OperationStats& file = stats.at("read_file").decode;
+    THES_ASSERT(file.calls == 1 && file.bytes == text.size() && file.failures == 0);
+
+    const Json exported = jay::statistics_json(stats);
+    THES_ASSERT(exported.at("test_two").at("encode").at("calls") == 5);
+    THES_ASSERT(exported.at("direction").at("decode").at("failures") == 2);
+    THES_ASSERT(exported.at("read_file").at("decode").at("bytes") == text.size());
+  }
+
+  jay::reset_statistics();
+  for (const auto& [name, stats] : jay::collect_statistics()) {
+    THES_ASSERT(stats.encode.calls == 0 && stats.decode.calls == 0 && stats.decode.bytes == 0);
+  }
+}
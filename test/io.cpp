@@ -0,0 +1,397 @@
+// This file is part of https://github.com/KurtBoehm/jaybird.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "thesauros/io.hpp"
+#include "thesauros/test.hpp"
+
+#include "jaybird/jaybird.hpp"
+
+int main() {
+  using jay::Json;
+  using Map = std::map<std::string, std::vector<double>>;
+
+  const auto path = std::filesystem::temp_directory_path() / "jaybird-io-test.json";
+  const std::string text = R"({"a": [1.5, 2.0], "b": [], "c": [-3.0]})";
+  {
+    std::ofstream out{path, std::ios::binary};
+    out << text;
+  }
+
+  {
+    const jay::FileContents contents{path};
+    THES_ASSERT(contents.is_mapped());
+    THES_ASSERT(thes::test::string_eq(contents.view(), text));
+  }
+  // Open regular files are mapped from their current position
+  if (std::FILE* file = std::fopen(path.c_str(), "rb"); file != nullptr) {
+    std::array<char, 5> prefix{};
+    THES_ASSERT(std::fread(prefix.data(), 1, prefix.size(), file) == prefix.size());
+    const jay::FileContents contents{file};
+    THES_ASSERT(contents.is_mapped());
+    THES_ASSERT(thes::test::string_eq(contents.view(), text.substr(prefix.size())));
+    THES_ASSERT(std::fgetc(file) == EOF);
+    std::fclose(file);
+  }
+  THES_ASSERT(jay::read_file(path) == Json::parse(text));
+  THES_ASSERT(jay::read_file(thes::FileReader{path}) == Json::parse(text));
+
+  const Map expected{{"a", {1.5, 2.0}}, {"b", {}}, {"c", {-3.0}}};
+  THES_ASSERT(jay::read_file<Map>(path) == expected);
+  THES_ASSERT(jay::read_file<Map>(thes::FileReader{path}) == expected);
+
+  // Files which cannot be mapped are read into a buffer
+  if (std::FILE* pipe = popen("printf '[1, 2, 3]'", "r"); pipe != nullptr) {
+    const jay::FileContents contents{pipe};
+    pclose(pipe);
+    THES_ASSERT(!contents.is_mapped());
+    THES_ASSERT(jay::parse<std::vector<int>>(contents.view()) == (std::vector<int>{1, 2, 3}));
+  }
+  if (const std::filesystem::path proc{"/proc/self/status"}; std::filesystem::exists(proc)) {
+    const jay::FileContents contents{proc};
+    THES_ASSERT(!contents.is_mapped() && !contents.view().empty());
+  }
+
+  // Writing replaces the target atomically and matches `Json::dump`
+  const Map written{{"x", {0.25}}, {"y", {1e300, -2.5}}};
+  jay::write_file(path, written);
+  THES_ASSERT(thes::test::string_eq(jay::FileContents{path}.view(), jay::to_json(written).dump()));
+  jay::write_file(path, jay::to_json(written), {.indent = 2, .sync = true});
+  THES_ASSERT(
+    thes::test::string_eq(jay::FileContents{path}.view(), jay::to_json(written).dump(2)));
+  THES_ASSERT(jay::read_file<Map>(path) == written);
+  for (const jay::Format format : {jay::Format::cbor, jay::Format::msgpack}) {
+    jay::write_file(path, written, {.format = format});
+    const auto bytes = format == jay::Format::cbor ? Json::to_cbor(jay::to_json(written))
+                                                   : Json::to_msgpack(jay::to_json(written));
+    auto same_byte = [](char c, std::uint8_t b) { return static_cast<std::uint8_t>(c) == b; };
+    THES_ASSERT(std::ranges::equal(jay::FileContents{path}.view(), bytes, same_byte));
+    THES_ASSERT(jay::read_file<Map>(path, format) == written);
+    THES_ASSERT(jay::read_file(path, format) == jay::to_json(written));
+  }
+  // The target keeps its mode, and new targets receive the default mode
+  {
+    using Perms = std::filesystem::perms;
+    const Perms mode = Perms::owner_read | Perms::owner_write | Perms::group_read;
+    std::filesystem::permissions(path, mode);
+    jay::write_file(path, written);
+    THES_ASSERT(std::filesystem::status(path).permissions() == mode);
+
+    const auto fresh = path.parent_path() / "jaybird-io-test-mode.json";
+    std::filesystem::remove(fresh);
+    const ::mode_t mask = ::umask(022);
+    jay::write_file(fresh, written);
+    ::umask(mask);
+    THES_ASSERT(std::filesystem::status(fresh).permissions() == (mode | Perms::others_read));
+    std::filesystem::remove(fresh);
+  }
+  for (const auto& entry : std::filesystem::directory_iterator{path.parent_path()}) {
+    const auto name = entry.path().filename().string();
+    THES_ASSERT(name == path.filename().string() || !name.starts_with(path.filename().string()));
+  }
+
+  // JSON Lines
+  {
+    jay::JsonLinesWriter<Map> writer{path};
+    writer.write(expected);
+    writer.write(written);
+  }
+  {
+    jay::JsonLinesWriter<Map> writer{path, true};
+    writer.write(Map{});
+  }
+  {
+    std::ofstream out{path, std::ios::binary | std::ios::app};
+    out << "\n{\"a\": 1}\r\n[1, 2\n{\"z\": [4.5]}";
+  }
+  {
+    std::vector<std::size_t> error_lines{};
+    jay::JsonLinesReader<Map> reader{
+      path, [&](const jay::LineError& error) { error_lines.push_back(error.line); }};
+    std::vector<Map> records{};
+    for (Map& record : reader) {
+      records.push_back(std::move(record));
+    }
+    const std::vector<Map> expected_records{expected, written, Map{}, Map{{"z", {4.5}}}};
+    THES_ASSERT(records == expected_records);
+    THES_ASSERT(error_lines == (std::vector<std::size_t>{5, 6}));
+    THES_ASSERT(reader.line_num() == 7);
+  }
+
+  // Incremental parsing of chunked input, where each chunk size is checked
+  {
+    const std::string stream =
+      R"({"a": [1.5, 2.0], "b\"]": []} ["}", {"[": 1}] 7 "s\\"true)" "\n{\"c\": [-3.0]} -1e2";
+    std::vector<Json> stream_values{};
+    for (const std::string_view value :
+         {R"({"a": [1.5, 2.0], "b\"]": []})", R"(["}", {"[": 1}])", "7", R"("s\\")", "true",
+          R"({"c": [-3.0]})", "-100.0"}) {
+      stream_values.push_back(Json::parse(value));
+    }
+    for (std::size_t size = 1; size <= stream.size(); ++size) {
+      jay::IncrementalParser<Json> parser{};
+      std::vector<Json> values{};
+      std::size_t completed = 0;
+      for (std::size_t begin = 0; begin < stream.size(); begin += size) {
+        completed += parser.feed(std::span{stream}.subspan(begin).first(
+          std::min(size, stream.size() - begin)));
+        THES_ASSERT(parser.buffered() <= stream.size());
+        while (auto value = parser.next()) {
+          values.push_back(std::move(*value));
+        }
+      }
+      // The last number is only complete at the end of the input
+      THES_ASSERT(completed == stream_values.size() - 1 && !parser.done());
+      parser.finish();
+      values.push_back(*parser.next());
+      THES_ASSERT(values == stream_values && parser.done() && parser.buffered() == 0);
+    }
+
+    // Values which cannot be decoded are reported in their place
+    jay::IncrementalParser<std::vector<int>> parser{};
+    const std::string_view invalid = "[1, 2} [3] [4,";
+    THES_ASSERT(parser.feed(invalid) == 2);
+    try {
+      parser.next();
+      return 1;
+    } catch (const Json::parse_error& /*ex*/) {
+    }
+    THES_ASSERT(parser.next() == (std::vector<int>{3}) && !parser.next().has_value());
+    THES_ASSERT(parser.buffered() == 3);
+    parser.finish();
+    try {
+      parser.next();
+      return 1;
+    } catch (const Json::parse_error& /*ex*/) {
+    }
+    THES_ASSERT(parser.done());
+
+    // Decoding within coroutines, where chunks are awaited
+    jay::IncrementalParser<Map> map_parser{};
+    const std::string maps = jay::to_json_string(expected) + jay::to_json_string(written);
+    std::size_t offset = 0;
+    auto read = [&]() -> jay::Task<std::span<const char>> {
+      const std::size_t size = std::min<std::size_t>(5, maps.size() - offset);
+      offset += size;
+      co_return std::span{maps}.subspan(offset - size, size);
+    };
+    auto collect = [&]() -> jay::Task<std::vector<Map>> {
+      std::vector<Map> out{};
+      while (auto value = co_await jay::next_value(map_parser, read)) {
+        out.push_back(std::move(*value));
+      }
+      co_return out;
+    };
+    THES_ASSERT(sync_wait(collect()) == (std::vector<Map>{expected, written}));
+  }
+
+  // Parallel decoding of records, where the keys check the structural scan
+  {
+    std::vector<Map> records{};
+    for (int i = 0; i < 500; ++i) {
+      const std::string slashes(static_cast<std::size_t>(i % 3), '\\');
+      const std::string key = fmt::format("k\\{}\"[,{}", slashes, i);
+      records.push_back(Map{{key, {static_cast<double>(i), 0.5}}, {"}", {}}});
+    }
+    const auto array_text = jay::to_json_string(records, 1);
+    std::string lines_text{};
+    for (const Map& record : records) {
+      lines_text += jay::to_json_string(record) + "\n\n";
+    }
+
+    for (const std::size_t thread_num : {1U, 4U}) {
+      const jay::ParallelOptions options{.thread_num = thread_num, .chunk_size = 97};
+      for (const std::string& records_text : {array_text, lines_text}) {
+        std::vector<Map> ordered{};
+        jay::parse_records<Map>(
+          records_text, [&](Map&& record) { ordered.push_back(std::move(record)); }, options);
+        THES_ASSERT(ordered == records);
+
+        std::vector<Map> unordered{};
+        jay::parse_records<Map>(
+          records_text, [&](Map&& record) { unordered.push_back(std::move(record)); },
+          {.thread_num = thread_num, .chunk_size = 97, .ordered = false});
+        std::ranges::sort(unordered);
+        auto sorted = records;
+        std::ranges::sort(sorted);
+        THES_ASSERT(unordered == sorted);
+      }
+
+      {
+        std::ofstream out{path, std::ios::binary};
+        out << array_text;
+      }
+      THES_ASSERT(jay::read_records<Map>(path, options) == records);
+    }
+
+    std::string compact_lines{};
+    for (const Map& record : records) {
+      compact_lines += jay::to_json_string(record) + "\n";
+    }
+    // Parallel writing produces the same output as the sequential paths
+    for (const std::size_t thread_num : {1U, 3U}) {
+      for (const std::size_t chunk_size : {1U, 100U, 1000000U}) {
+        const jay::ParallelOptions options{.thread_num = thread_num, .chunk_size = chunk_size};
+        for (const int indent : {-1, 0, 2}) {
+          std::string out{};
+          jay::ContainerSink sink{out};
+          jay::write_range(records, sink, options, jay::RecordLayout::array, indent);
+          THES_ASSERT(out == jay::to_json(records).dump(indent));
+        }
+        std::string out{};
+        jay::ContainerSink sink{out};
+        jay::write_range(records, sink, options, jay::RecordLayout::json_lines);
+        THES_ASSERT(out == compact_lines);
+        out.clear();
+        jay::write_range(std::vector<Map>{}, sink, options);
+        THES_ASSERT(out == "[]");
+      }
+    }
+
+    auto fails = [](std::string_view input) {
+      try {
+        jay::parse_records<std::vector<int>>(input, [](std::vector<int>&& /*r*/) {},
+                                             {.thread_num = 4, .chunk_size = 4});
+        return false;
+      } catch (const std::exception& /*ex*/) {
+        return true;
+      }
+    };
+    THES_ASSERT(!fails("[[1], [2, 3], []]") && !fails(" [ ] "));
+    THES_ASSERT(fails("[[1], [2, 3], ]") && fails("[[1],, [2]]") && fails("[[1], [\"a\"]]"));
+  }
+
+  // Lazy documents only decode the values which are accessed
+  {
+    const std::string doc_text = R"( {"config": {"name": "x\"y", "limits": [1, 2.5, -3]},
+      "state": [{"a/b": {"m~n": [true, null]}}, {"big": [[], {}, "]}"]}],
+      "dup": 1, "es\u0063aped": "yes", "dup": [2]} )";
+    {
+      std::ofstream out{path, std::ios::binary};
+      out << doc_text;
+    }
+    const jay::LazyDocument doc{path};
+    const Json reference = Json::parse(doc_text);
+    THES_ASSERT(doc.root().size() == 5 && doc.value_num() == 22);
+    for (const std::string_view pointer :
+         {"", "/config", "/config/name", "/config/limits/1", "/state/0/a~1b/m~0n", "/state/1/big",
+          "/state/1/big/2", "/dup", "/escaped"}) {
+      const Json::json_pointer json_pointer{std::string{pointer}};
+      THES_ASSERT(doc.at(pointer).dom() == reference.at(json_pointer));
+    }
+    THES_ASSERT(doc.get<std::vector<double>>("/config/limits") ==
+                (std::vector<double>{1.0, 2.5, -3.0}));
+    THES_ASSERT(doc.root().at("config").at("name").get<std::string>() == "x\"y");
+    THES_ASSERT(doc.at("/state/1/big/1").is_object() && doc.at("/state/1/big").is_array());
+    THES_ASSERT(doc.at("/config/limits").text() == "[1, 2.5, -3]");
+    THES_ASSERT(!doc.root().find("missing").has_value());
+
+    auto message = [](auto op) {
+      try {
+        op();
+      } catch (const std::exception& ex) {
+        return std::string{ex.what()};
+      }
+      return std::string{};
+    };
+    for (const std::string_view pointer :
+         {"/missing", "/state/2", "/state/x", "/state/x1", "/state/01", "/state/-", "/state/1x",
+          "/dup/0/1", "config", "/config/name/0", "/a~2"}) {
+      const std::string error =
+        message([&] { return reference.at(Json::json_pointer{std::string{pointer}}); });
+      THES_ASSERT(!error.empty() && message([&] { return doc.at(pointer); }) == error);
+    }
+
+    for (const std::string_view bad : {"", "[1, 2", "{\"a\" 1}", "[1,]", "{\"a\": 1,}", "[1] 2",
+                                       "\"abc", "{1: 2}"}) {
+      THES_ASSERT(!message([&] { return jay::LazyDocument{bad}; }).empty());
+    }
+    // Values are only validated when they are decoded
+    const jay::LazyDocument lenient{"[1, tru, {\"a\": 2}]"};
+    THES_ASSERT(lenient.get<int>("/2/a") == 2);
+    THES_ASSERT(!message([&] { return lenient.get<bool>("/1"); }).empty());
+  }
+
+  // Configuration which is reloaded when the file changes
+  {
+    const auto config_path = std::filesystem::temp_directory_path() / "jaybird-live-config.json";
+    jay::write_file(config_path, expected);
+    std::vector<std::string> errors{};
+    std::mutex errors_mutex{};
+    jay::LiveConfig<Map> config{config_path,
+                                {.poll_interval = std::chrono::milliseconds{20}},
+                                [&](const jay::ReloadError& error) {
+                                  const std::lock_guard lock{errors_mutex};
+                                  errors.push_back(error.message);
+                                }};
+    auto reader = config.reader();
+    const jay::LiveConfig<Map>::Snapshot first = config.snapshot();
+    THES_ASSERT(*first == expected && *reader == expected && config.version() == 1);
+
+    // Waits up to ten seconds for the version to reach `version`
+    auto await_version = [&](std::uint64_t version) {
+      for (int i = 0; i < 1000 && config.version() < version; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+      }
+      return config.version() >= version;
+    };
+
+    jay::write_file(config_path, written);
+    THES_ASSERT(await_version(2));
+    THES_ASSERT(*config.snapshot() == written && *reader == written && !config.last_error());
+    // Earlier snapshots are unchanged
+    THES_ASSERT(*first == expected);
+
+    // Invalid files are reported and the previous snapshot is kept
+    {
+      std::ofstream out{config_path, std::ios::binary};
+      out << R"({"a": "text"})";
+    }
+    for (int i = 0; i < 1000 && !config.last_error(); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    THES_ASSERT(config.last_error().has_value() && *reader == written);
+    THES_ASSERT(config.last_error()->pointer == "/a");
+    {
+      const std::lock_guard lock{errors_mutex};
+      THES_ASSERT(!errors.empty() && errors.back() == config.last_error()->message);
+    }
+
+    jay::write_file(config_path, Map{});
+    THES_ASSERT(config.reload() && !config.last_error() && reader->empty());
+    std::filesystem::remove(config_path);
+    THES_ASSERT(!config.reload() && reader->empty());
+    THES_ASSERT(config.last_error().has_value() && config.last_error()->pointer.empty());
+
+    // Loading reports the value which cannot be decoded
+    jay::write_file(config_path, Json{{"b", {1.0, "x"}}});
+    try {
+      const jay::LiveConfig<Map> invalid{config_path};
+      return 1;
+    } catch (const jay::ConfigDecodeError& ex) {
+      THES_ASSERT(ex.pointer() == "/b/1");
+    }
+    std::filesystem::remove(config_path);
+  }
+
+  std::filesystem::remove(path);
+}
@@ -4,12 +4,28 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <random>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <variant>
+#include <vector>
 
+#include "ankerl/unordered_dense.h"
 #include "nlohmann/json.hpp"
 #include "thesauros/thesauros.hpp"
 
@@ -32,6 +48,11 @@ struct Test3 {
 struct Test4 {
   THES_DEFINE_TYPE(NAMED(Test4, "test_4"), CONSTEXPR_CONSTRUCTOR)
 };
+struct Labels {
+  THES_DEFINE_TYPE(SNAKE_CASE(Labels), CONSTEXPR_CONSTRUCTOR,
+                   MEMBERS((KEEP(id), std::string), (KEEP(paths), std::vector<std::string>),
+                           (KEEP(note), std::optional<std::string>, {})))
+};
 
 THES_DEFINE_ENUM(SNAKE_CASE(Direction), bool, LOWERCASE(FORWARD), LOWERCASE(BACKWARD));
 template<Direction tVal, typename TType>
@@ -49,6 +70,45 @@ using Member0 = std::tuple_element_t<0, Members>;
 inline constexpr auto name = Member0::name;
 inline constexpr auto ptr = Member0::pointer;
 
+inline constexpr auto hash_keys = [] {
+  std::array<std::string_view, 64> keys{};
+  constexpr std::string_view chars =
+    "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ__";
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = chars.substr(i, 1 + (i % 3));
+  }
+  return keys;
+}();
+inline constexpr jay::PerfectHash key_hash{hash_keys};
+static_assert([] {
+  for (std::size_t i = 0; i < hash_keys.size(); ++i) {
+    if (key_hash.find(hash_keys[i]) != i) {
+      return false;
+    }
+  }
+  return !key_hash.find("").has_value() && !key_hash.find("abcd").has_value() &&
+         !key_hash.find("zz").has_value();
+}());
+
+// Values without floating-point numbers can be rendered at compile time,
+inline constexpr auto static_five = jay::static_dump([] { return Test5{3}; });
+static_assert(static_five.view() == R"({"a":3,"type":"f32","value":"forward"})");
+static_assert(jay::static_dump([] {
+                return std::optional{std::vector{Direction::FORWARD, Direction::BACKWARD}};
+              }).view() == R"(["forward","backward"])");
+static_assert(jay::static_dump([] {
+                return std::variant<Test4, Test5>{Test5{-1}};
+              }).view() == R"({"templ5":{"a":-1,"type":"f32","value":"forward"}})");
+static_assert(jay::static_dump([] {
+                return std::array<std::string, 2>{"a\"b\n", "\x01"};
+              }).view() == R"(["a\"b\n","\u0001"])");
+// which is checked before rendering, whereas floating-point numbers and DOMs are rejected
+static_assert(jay::detail::is_renderable([] { return Test5{3}; }));
+static_assert(!jay::detail::is_renderable([] { return Test1{0.0, {2.0, 3}, 1}; }));
+static_assert(!jay::detail::is_renderable([] { return std::optional{0.5}; }));
+static_assert(jay::detail::is_renderable([] { return std::optional<double>{}; }));
+static_assert(!jay::detail::is_renderable([] { return std::pair{1, 2}; }));
+
 int main() {
   using jay::Json;
 
@@ -58,14 +118,25 @@ int main() {
     static_assert(a == 0.0F);
 
     THES_ASSERT(thes::test::string_eq(R"({"a":0.0,"b":[2.0,3],"c":1})", jay::to_json(test).dump()));
+    THES_ASSERT(thes::test::string_eq(jay::to_json(test).dump(), jay::to_json_string(test)));
     fmt::print("\n");
   }
+  {
+    // Pre-rendered keys and static members are written like all other entries
+    const Test5 value{-3};
+    for (const int indent : {-1, 0, 2}) {
+      THES_ASSERT(jay::to_json_string(value, indent) == jay::to_json(value).dump(indent));
+    }
+    THES_ASSERT(static_five.view() == jay::to_json(Test5{3}).dump());
+  }
 
   {
     constexpr Test1 test1{0.0, {2.0, 3}, 1};
     constexpr TestTwo test2{5.0, test1};
     THES_ASSERT(thes::test::string_eq(R"({"a":5.0,"b":{"a":0.0,"b":[2.0,3],"c":1},"c":0})",
                                       jay::to_json(test2).dump()));
+    THES_ASSERT(thes::test::string_eq(jay::to_json(test2).dump(), jay::to_json_string(test2)));
+    THES_ASSERT(thes::test::string_eq(jay::to_json(test2).dump(2), jay::to_json_string(test2, 2)));
     fmt::print("\n");
   }
 
@@ -80,11 +151,14 @@ int main() {
     {
       auto json = jay::to_json(var1);
       THES_ASSERT(thes::test::string_eq(R"({"Test1":{"a":0.0,"b":[2.0,3],"c":1}})", json.dump()));
+      THES_ASSERT(thes::test::string_eq(json.dump(), jay::to_json_string(var1)));
 
       auto json_out = Json::parse(json.dump());
       auto test_out = jay::from_json<Var>(json_out);
       THES_ASSERT(thes::test::string_eq(R"({"Test1":{"a":0.0,"b":[2.0,3],"c":1}})",
                                         jay::to_json(test_out).dump()));
+      THES_ASSERT(thes::test::string_eq(json.dump(),
+                                        jay::to_json_string(jay::parse<Var>(json.dump()))));
       fmt::print("\n");
     }
 
@@ -92,6 +166,7 @@ int main() {
       auto json = jay::to_json(var2);
       THES_ASSERT(thes::test::string_eq(
         R"({"test_two":{"a":5.0,"b":{"a":0.0,"b":[2.0,3],"c":1},"c":0}})", json.dump()));
+      THES_ASSERT(thes::test::string_eq(json.dump(), jay::to_json_string(var2)));
 
       auto json_out = Json::parse(json.dump());
       auto test_out = jay::from_json<Var>(json_out);
@@ -109,12 +184,15 @@ int main() {
     auto json = jay::to_json(var);
     THES_ASSERT(thes::test::string_eq(
       R"({"test_3":{"a":0.0,"b":{"Test1":{"a":0.0,"b":[2.0,3],"c":3}}}})", json.dump()));
+    THES_ASSERT(thes::test::string_eq(json.dump(), jay::to_json_string(var)));
 
     auto json_out = Json::parse(json.dump());
     auto test_out = jay::from_json<Var>(json_out);
     THES_ASSERT(
       thes::test::string_eq(R"({"test_3":{"a":0.0,"b":{"Test1":{"a":0.0,"b":[2.0,3],"c":3}}}})",
                             jay::to_json(test_out).dump()));
+    THES_ASSERT(
+      thes::test::string_eq(json.dump(), jay::to_json_string(jay::parse<Var>(json.dump()))));
   }
   fmt::print("\n");
 
@@ -122,6 +200,7 @@ int main() {
     const Test5 value0a{3};
     THES_ASSERT(thes::test::string_eq(R"({"a":3,"type":"f32","value":"forward"})",
                                       jay::to_json(value0a).dump()));
+    THES_ASSERT(thes::test::string_eq(jay::to_json(value0a).dump(), jay::to_json_string(value0a)));
 
     Json json0{};
     const auto value0b = jay::from_json<Test5>(jay::to_json(value0a));
@@ -142,12 +221,200 @@ int main() {
     if (value2.index() != 1) {
       return 1;
     }
+    if (jay::parse<Type>(json2.dump()) != value2) {
+      return 1;
+    }
+
+    using Mixed = std::variant<Test1, Templ5<Direction::FORWARD, float>, TestTwo,
+                               Templ5<Direction::BACKWARD, int>>;
+    if (jay::from_json<Mixed>(json2).index() != 3 || jay::parse<Mixed>(json2.dump()).index() != 3) {
+      return 1;
+    }
+    if (jay::parse<Mixed>(R"({"test_two":{"a":1,"b":{"a":0,"b":[2,3],"c":1},"c":2}})").index() !=
+        2) {
+      return 1;
+    }
+    try {
+      jay::from_json<Mixed>(R"({"templ5":{"type":"i32","value":"forward","a":5}})"_json);
+      return 1;
+    } catch (const std::invalid_argument& ex) {
+      THES_ASSERT(thes::test::string_eq(
+        ex.what(), "This is not a known variant! Keys: (\"Test1\", \"templ5\", \"test_two\", "
+                   "\"templ5\")\nErrors that occurred when checking variants with the same name: "
+                   "[\"The value of key type is \\\"i32\\\", not \\\"f32\\\"!\", "
+                   "\"The value of key value is \\\"forward\\\", not \\\"backward\\\"!\"]"));
+    }
+    if (jay::parse<Test5>(R"({"b":[1,{}],"value":"forward","a":3,"type":"f32"})") != value0a) {
+      return 1;
+    }
+    if (jay::from_json<Test5>(R"({"b":[1,{}],"value":"forward","a":3,"type":"f32"})"_json) !=
+        value0a) {
+      return 1;
+    }
 
     thes::LimitedArray<double, 4> arr{1.0, 5.0, 3.0};
     const auto value3 = jay::from_json<decltype(arr)>(jay::to_json(arr));
     if (value3 != arr) {
       return 1;
     }
+    if (jay::parse<decltype(arr)>("[1.0, 5, 3.0]") != arr) {
+      return 1;
+    }
+    THES_ASSERT(thes::test::string_eq(jay::to_json(arr).dump(), jay::to_json_string(arr)));
+  }
+  fmt::print("\n");
+
+  {
+    const std::vector<float> floats{1.5F, -2.0F, 3.25F};
+    THES_ASSERT(thes::test::string_eq("[1.5,-2.0,3.25]", jay::to_json_string(floats)));
+    THES_ASSERT(thes::test::string_eq(jay::to_json(floats).dump(), jay::to_json_string(floats)));
+    THES_ASSERT(jay::from_json<std::vector<float>>(jay::to_json(floats)) == floats);
+    THES_ASSERT(jay::parse<std::vector<float>>("[1.5, -2, 3.25]") == floats);
+
+    // `float`s are stored as the double closest to their shortest representation, which is
+    // written instead of the exactly widened double both with and without a DOM
+    const std::vector<float> shortest{0.1F, -1e-7F, 3.4028235e38F, 1e20F, 16777216.0F,
+                                      1e-45F, 0.0F, -0.0F, 123456.79F};
+    const std::string text = jay::to_json_string(shortest);
+    THES_ASSERT(thes::test::string_eq(
+      "[0.1,-1e-07,3.4028235e+38,1e+20,16777216.0,1e-45,0.0,-0.0,123456.79]", text));
+    THES_ASSERT(jay::to_json(0.1F) == Json(0.1));
+    THES_ASSERT(thes::test::string_eq(jay::to_json(shortest).dump(), text));
+    THES_ASSERT(jay::from_json<std::vector<float>>(jay::to_json(shortest)) == shortest);
+    THES_ASSERT(jay::parse<std::vector<float>>(text) == shortest);
+    THES_ASSERT(jay::from_json<std::vector<float>>(Json::parse(text)) == shortest);
+    // Decimals are rounded to `float` via `double` like in the DOM, which rounds the value
+    // above the midpoint between 1 and the next float to the midpoint and then to 1
+    const std::string_view above_midpoint = "1.0000000596046447753906251";
+    THES_ASSERT(jay::parse<float>(above_midpoint) == 1.0F);
+    THES_ASSERT(jay::from_json<float>(Json::parse(above_midpoint)) == 1.0F);
+    THES_ASSERT(jay::parse<float>("1e-50") == 0.0F);
+    // The only float whose shortest representation rounds to a different float via double
+    THES_ASSERT(jay::to_json(7.038531e-26F) == Json(static_cast<double>(7.038531e-26F)));
+    THES_ASSERT(jay::parse<float>(jay::to_json_string(7.038531e-26F)) == 7.038531e-26F);
+
+    // All floats of a sample round-trip exactly and are written like their DOM, which is
+    // considerably shorter on average than the exactly widened double
+    std::mt19937 rng{42}; // NOLINT
+    std::size_t float_size = 0;
+    std::size_t double_size = 0;
+    for (std::size_t i = 0; i < 100000; ++i) {
+      const auto value = std::bit_cast<float>(static_cast<std::uint32_t>(rng()));
+      if (!std::isfinite(value)) {
+        continue;
+      }
+      const std::string str = jay::to_json_string(value);
+      const std::string widened = Json(static_cast<double>(value)).dump();
+      THES_ASSERT(jay::parse<float>(str) == value);
+      THES_ASSERT(jay::from_json<float>(jay::to_json(value)) == value);
+      THES_ASSERT(jay::from_json<float>(Json::parse(str)) == value);
+      THES_ASSERT(str == jay::to_json(value).dump());
+      float_size += str.size();
+      double_size += widened.size();
+
+      // Doubles are written exactly like `Json::dump`
+      const auto real = std::bit_cast<double>((std::uint64_t{rng()} << 32U) | rng());
+      if (std::isfinite(real)) {
+        const std::string real_str = jay::to_json_string(real);
+        THES_ASSERT(jay::parse<double>(real_str) == real);
+        THES_ASSERT(real_str == Json(real).dump());
+      }
+    }
+    THES_ASSERT(2 * float_size < double_size + double_size / 2);
+    THES_ASSERT(thes::test::string_eq("0.1", jay::to_json_string(0.1)));
+    THES_ASSERT(jay::from_json<std::vector<int>>("[1, 2.5, true]"_json) ==
+                (std::vector<int>{1, 2, 1}));
+
+    const std::vector<Test1> tests{Test1{0.0, {2.0, 3}, 1}, Test1{1.0, {0.5, 2}, 4}};
+    THES_ASSERT(thes::test::string_eq(jay::to_json(tests).dump(2), jay::to_json_string(tests, 2)));
+    THES_ASSERT(thes::test::string_eq(
+      jay::to_json_string(tests),
+      jay::to_json_string(jay::parse<std::vector<Test1>>(jay::to_json_string(tests)))));
+
+    const std::array<int, 3> ints{4, 5, 6};
+    THES_ASSERT(thes::test::string_eq("[4,5,6]", jay::to_json_string(ints)));
+    THES_ASSERT((jay::from_json<std::array<int, 3>>("[4, 5, 6, 7]"_json) == ints));
+    THES_ASSERT((jay::parse<std::array<int, 3>>("[4, 5, 6, 7]") == ints));
+    try {
+      jay::parse<std::array<int, 3>>("[4, 5]");
+      return 1;
+    } catch (const Json::out_of_range& ex) {
+      THES_ASSERT(thes::test::string_eq(
+        ex.what(), "[json.exception.out_of_range.401] array index 2 is out of range"));
+    }
+
+    const std::unordered_map<std::string, std::vector<Direction>> dirs{
+      {"b", {Direction::FORWARD}}, {"a", {}}, {"c", {Direction::BACKWARD, Direction::FORWARD}}};
+    THES_ASSERT(thes::test::string_eq(R"({"a":[],"b":["forward"],"c":["backward","forward"]})",
+                                      jay::to_json_string(dirs)));
+    THES_ASSERT(thes::test::string_eq(jay::to_json(dirs).dump(), jay::to_json_string(dirs)));
+    THES_ASSERT((jay::parse<std::unordered_map<std::string, std::vector<Direction>>>(
+                   jay::to_json_string(dirs)) == dirs));
+    const std::map<std::string, int> counts{{"x", 1}, {"y", 2}};
+    THES_ASSERT(thes::test::string_eq(jay::to_json(counts).dump(), jay::to_json_string(counts)));
+    THES_ASSERT((jay::parse<std::map<std::string, int>>(R"({"x":0,"y":2,"x":1})") == counts));
+
+    const auto bad = jay::try_from_json<std::map<std::string, std::vector<Direction>>>(
+      R"({"a":["forward"],"b":["forward","up"]})"_json);
+    THES_ASSERT(!bad.has_value());
+    THES_ASSERT(thes::test::string_eq(bad.error().pointer(), "/b/1"));
+  }
+  fmt::print("\n");
+
+  {
+    using Uni =
+      jay::UniVariant<Templ5<Direction::FORWARD, float>, Templ5<Direction::BACKWARD, int>>;
+    const Uni uni{Templ5<Direction::BACKWARD, int>{7}};
+    THES_ASSERT(thes::test::string_eq(jay::to_json(uni).dump(), jay::to_json_string(uni)));
+    THES_ASSERT(thes::test::string_eq(jay::to_json(uni).dump(4), jay::to_json_string(uni, 4)));
+    THES_ASSERT(thes::test::string_eq(
+      jay::to_json(uni).dump(), jay::to_json_string(jay::parse<Uni>(jay::to_json_string(uni)))));
+
+    using Uni3 = jay::UniVariant<Templ5<Direction::FORWARD, float>,
+                                 Templ5<Direction::BACKWARD, int>, Templ5<Direction::FORWARD, int>>;
+    if (jay::from_json<Uni3>(R"({"a":1,"type":"f32","value":"forward"})"_json).index() != 0 ||
+        jay::from_json<Uni3>(R"({"a":1,"type":"i32","value":"backward"})"_json).index() != 1 ||
+        jay::from_json<Uni3>(R"({"a":1,"type":"i32","value":"forward"})"_json).index() != 2) {
+      return 1;
+    }
+    try {
+      jay::from_json<Uni3>(R"({"a":1,"type":"f32","value":"backward"})"_json);
+      return 1;
+    } catch (const std::invalid_argument& ex) {
+      THES_ASSERT(thes::test::string_eq(
+        ex.what(), "This is not a known variant! Keys: (\"templ5\", \"templ5\", \"templ5\")\n"
+                   "Errors that occurred when checking variants with the same name: "
+                   "[\"The value of key value is \\\"backward\\\", not \\\"forward\\\"!\", "
+                   "\"The value of key type is \\\"f32\\\", not \\\"i32\\\"!\", "
+                   "\"The value of key value is \\\"backward\\\", not \\\"forward\\\"!\"]"));
+    }
+
+    const std::optional<Direction> dir{Direction::BACKWARD};
+    THES_ASSERT(thes::test::string_eq(R"("backward")", jay::to_json_string(dir)));
+    THES_ASSERT(thes::test::string_eq("null", jay::to_json_string(std::optional<Direction>{})));
+
+    const Json json{{"text", "q\"u\\o\te\u0001\u007f\u00e4\U0001F426"},
+                    {"nums", {-1, 2U, 0.1, -0.0, 1e300, std::numeric_limits<double>::infinity()}},
+                    {"empty", Json::object()},
+                    {"nested", {Json::array(), nullptr, true}}};
+    THES_ASSERT(thes::test::string_eq(json.dump(), jay::to_json_string(json)));
+    THES_ASSERT(thes::test::string_eq(json.dump(3), jay::to_json_string(json, 3)));
+
+    fmt::memory_buffer buffer{};
+    jay::write_json(buffer, Test1{0.5, {2.0, 3}, 1});
+    THES_ASSERT(thes::test::string_eq(R"({"a":0.5,"b":[2.0,3],"c":1})", fmt::to_string(buffer)));
+
+    std::string str{};
+    jay::write_json(std::back_inserter(str), Test1{0.5, {2.0, 3}, 1});
+    THES_ASSERT(thes::test::string_eq(R"({"a":0.5,"b":[2.0,3],"c":1})", str));
+
+    try {
+      jay::to_json_string(std::string{"\xC3\x28"});
+      return 1;
+    } catch (const Json::type_error& ex) {
+      THES_ASSERT(thes::test::string_eq(
+        ex.what(), "[json.exception.type_error.316] invalid UTF-8 byte at index 1: 0x28"));
+    }
   }
   fmt::print("\n");
 
@@ -179,4 +446,458 @@ int main() {
                    "[\"[json.exception.type_error.302] type must be number, but is string\"]"));
     }
   }
+
+  fmt::print("\n");
+
+  {
+    // The typed parser reports the same errors as the DOM-based path
+    auto dom_error = []<typename T>(thes::TypeTag<T> /*tag*/, const std::string& text) {
+      try {
+        jay::from_json<T>(Json::parse(text));
+      } catch (const std::exception& ex) {
+        return std::string{ex.what()};
+      }
+      return std::string{};
+    };
+    auto parse_error = []<typename T>(thes::TypeTag<T> /*tag*/, const std::string& text) {
+      try {
+        jay::parse<T>(text);
+      } catch (const std::exception& ex) {
+        return std::string{ex.what()};
+      }
+      return std::string{};
+    };
+    auto check = [&]<typename T>(thes::TypeTag<T> tag, const std::string& text) {
+      const auto expected = dom_error(tag, text);
+      THES_ASSERT(!expected.empty());
+      THES_ASSERT(thes::test::string_eq(expected, parse_error(tag, text)));
+      // Other DOMs report the same errors
+      if (Json::accept(text)) {
+        const auto arena = jay::ArenaJson::parse(text);
+        try {
+          jay::from_json<T>(arena);
+          THES_ASSERT(false);
+        } catch (const std::exception& ex) {
+          THES_ASSERT(thes::test::string_eq(expected, ex.what()));
+        }
+      }
+    };
+
+    try {
+      jay::from_json<Test1>(R"({"a":0.0,"b":[2.0,3]})"_json);
+      return 1;
+    } catch (const Json::out_of_range& ex) {
+      THES_ASSERT(
+        thes::test::string_eq(ex.what(), "[json.exception.out_of_range.403] key 'c' not found"));
+    }
+    check(thes::type_tag<Test1>, R"({"a":0.0,"b":[2.0,3]})");
+    check(thes::type_tag<Test1>, R"({"a":"x","b":[2.0,3],"c":1})");
+    // Members are checked in declaration order, regardless of the order of the entries
+    check(thes::type_tag<Test1>, R"({"c":"x","b":[1,2]})");
+    THES_ASSERT(thes::test::string_eq(dom_error(thes::type_tag<Test1>, R"({"c":"x","b":[1,2]})"),
+                                      "[json.exception.out_of_range.403] key 'a' not found"));
+    check(thes::type_tag<Test1>, R"({"c":"y","b":"x","a":1.0})");
+    // The last entry with a key is decoded, as in the DOM
+    check(thes::type_tag<Test1>, R"({"a":0.0,"b":[2.0,3],"c":1,"a":"x"})");
+    THES_ASSERT(jay::parse<Test1>(R"({"a":"x","b":[2.0,3],"c":1,"a":0.5})").a == 0.5F);
+    check(thes::type_tag<Test1>, R"({"a":0.0,"b":[2.0,3],"c":1)");
+    check(thes::type_tag<Test1>, R"({"a":0.0,"b":[2.0,3],"c":1}})");
+    // Syntax errors after a value which cannot be decoded take precedence
+    check(thes::type_tag<Test1>, R"({"a":"x","b":[2.0,3],"c":1)");
+    check(thes::type_tag<Test1>, R"({"a":{"x":[true]},"b":[2.0,"y"],"c":1e999})");
+    check(thes::type_tag<std::vector<Test1>>, R"([{"a":"x","b":[2.0,3],"c":1}, nul])");
+    check(thes::type_tag<Test5>, R"({"a":"x","type":"i32","value":"forward"})");
+    check(thes::type_tag<Test5>, R"({"a":3,"value":"forward"})");
+    check(thes::type_tag<Test5>, R"({"a":[{"x":[1]}],"type":"f32","value":"forward"})");
+    check(thes::type_tag<std::vector<Test5>>, R"([{"a":[[1],{}],"value":"backward"}])");
+    check(thes::type_tag<std::variant<Test1, TestTwo>>, R"({"test_3":{}})");
+    check(thes::type_tag<std::variant<thes::i32, thes::f32>>, R"({"i32":"a"})");
+    check(thes::type_tag<Direction>, R"("sideways")");
+    check(thes::type_tag<Direction>, R"(1)");
+
+    try {
+      jay::from_json<Direction>(Json("sideways"));
+      return 1;
+    } catch (const std::invalid_argument& ex) {
+      THES_ASSERT(thes::test::string_eq(
+        ex.what(), fmt::format("The value sideways is not a valid value for the enum {}!",
+                               thes::EnumInfo<Direction>::name.view())));
+    }
+    try {
+      jay::from_json<Direction>(Json(1));
+      return 1;
+    } catch (const Json::type_error& ex) {
+      THES_ASSERT(thes::test::string_eq(
+        ex.what(), "[json.exception.type_error.302] type must be string, but is number"));
+    }
+    THES_ASSERT(jay::from_json<Direction>(Json("backward")) == Direction::BACKWARD);
+    THES_ASSERT(jay::parse<Direction>(R"("forward")") == Direction::FORWARD);
+  }
+
+  {
+    // Nesting beyond the maximum depth is rejected instead of exhausting the stack
+    auto nested = [](std::size_t depth) {
+      return std::string(depth, '[') + std::string(depth, ']');
+    };
+    THES_ASSERT(jay::parse<Json>(nested(jay::default_max_depth)) ==
+                Json::parse(nested(jay::default_max_depth)));
+    auto depth_error = [](auto op) {
+      try {
+        op();
+      } catch (const Json::parse_error& ex) {
+        return std::string{ex.what()};
+      }
+      return std::string{};
+    };
+    const std::string expected = "[json.exception.parse_error.101] parse error at line 1, "
+                                 "column 513: maximum nesting depth of 512 exceeded";
+    THES_ASSERT(thes::test::string_eq(
+      depth_error([&] { jay::parse<Json>(nested(1000000)); }), expected));
+    THES_ASSERT(thes::test::string_eq(
+      depth_error([&] { jay::parse<std::vector<Json>>(nested(1000000)); }), expected));
+    const std::string deep_member = R"({"x":)" + nested(1000000) + "}";
+    THES_ASSERT(!depth_error([&] { jay::parse<std::optional<Test1>>(deep_member); }).empty());
+    const auto deep_cbor = std::string(1000000, '\x81');
+    THES_ASSERT(!depth_error([&] { jay::parse_cbor<Json>(deep_cbor); }).empty());
+    const auto deep_msgpack = std::string(1000000, '\x91');
+    THES_ASSERT(!depth_error([&] { jay::parse_msgpack<Json>(deep_msgpack); }).empty());
+  }
+
+  {
+    auto try_error = []<typename T>(thes::TypeTag<T> /*tag*/, const Json& json) {
+      const auto value = jay::try_from_json<T>(json);
+      THES_ASSERT(!value.has_value());
+      return std::pair{std::string{value.error().what()}, value.error().pointer()};
+    };
+    auto check = [&]<typename T>(thes::TypeTag<T> tag, const std::string& text,
+                                 std::string_view pointer) {
+      const auto json = Json::parse(text);
+      const auto [msg, error_pointer] = try_error(tag, json);
+      THES_ASSERT(thes::test::string_eq(error_pointer, pointer));
+      try {
+        jay::from_json<T>(json);
+        return 1;
+      } catch (const std::exception& ex) {
+        THES_ASSERT(thes::test::string_eq(msg, ex.what()));
+      }
+      return 0;
+    };
+
+    const auto test3 = jay::try_from_json<Test3>(
+      R"({"a":1.0,"b":{"test_two":{"a":5.0,"b":{"a":0.0,"b":[2.0,3],"c":1},"c":0}}})"_json);
+    THES_ASSERT(test3.has_value() && test3->b.index() == 1);
+    THES_ASSERT(jay::try_from_json<Test5>(R"({"a":3,"type":"f32","value":"forward"})"_json) ==
+                Test5{3});
+
+    int fails = 0;
+    fails += check(thes::type_tag<Test1>, R"({"a":0.0,"b":[2.0,3]})", "");
+    fails += check(thes::type_tag<Test1>, R"({"a":"x","b":[2.0,3],"c":1})", "/a");
+    fails += check(thes::type_tag<Test1>, R"({"c":"x","b":[1,2]})", "");
+    fails += check(thes::type_tag<Test1>, R"({"c":"y","b":"x","a":1.0})", "/b");
+    fails += check(thes::type_tag<Test1>, R"([1])", "");
+    fails += check(thes::type_tag<Test3>, R"({"a":1.0,"b":{"Test1":{"a":0,"b":[2,3],"c":"1"}}})",
+                   "/b/Test1/c");
+    fails += check(thes::type_tag<Test5>, R"({"a":3,"type":"i32","value":"forward"})", "/type");
+    fails += check(thes::type_tag<Test5>, R"({"a":3,"value":"forward"})", "");
+    fails += check(thes::type_tag<Direction>, R"("sideways")", "");
+    fails += check(thes::type_tag<Direction>, R"(1)", "");
+    fails += check(thes::type_tag<thes::LimitedArray<Direction, 3>>, R"(["forward","up"])", "/1");
+    fails += check(thes::type_tag<std::variant<thes::i32, thes::f32>>, R"({"i32":"a"})", "");
+    if (fails > 0) {
+      return 1;
+    }
+
+    const auto [msg, error_pointer] =
+      try_error(thes::type_tag<std::optional<Test1>>, R"({"a/b~":1})"_json);
+    THES_ASSERT(thes::test::string_eq(msg, "[json.exception.out_of_range.403] key 'a' not found"));
+    THES_ASSERT(thes::test::string_eq(error_pointer, ""));
+    THES_ASSERT(thes::test::string_eq(
+      jay::DecodeError{"x"}.at("a/b~").at(std::size_t{2}).pointer(), "/2/a~1b~0"));
+    const auto null_test1 = jay::try_from_json<std::optional<Test1>>(Json{});
+    THES_ASSERT(null_test1.has_value() && !null_test1->has_value());
+  }
+
+  {
+    auto check = []<typename T>(const T& value) {
+      const Json json = jay::to_json(value);
+      const auto cbor = jay::to_cbor(value);
+      const auto msgpack = jay::to_msgpack(value);
+      THES_ASSERT(cbor == Json::to_cbor(json));
+      THES_ASSERT(msgpack == Json::to_msgpack(json));
+      THES_ASSERT(jay::to_json(jay::parse_cbor<T>(cbor)) == json);
+      THES_ASSERT(jay::to_json(jay::parse_msgpack<T>(msgpack)) == json);
+    };
+
+    check(Test3{1.0, TestTwo{5.0, Test1{0.0, {2.0, 3}, 1}}});
+    check(Test5{3});
+    check(std::vector<Direction>{Direction::FORWARD, Direction::BACKWARD});
+    check(std::vector<std::variant<Test1, TestTwo>>{Test1{0.5, {0.1F, -7}, 2}, TestTwo{}});
+    check(std::vector<std::int64_t>{0, 23, 24, 127, 128, 255, 256, 65535, 65536, 4294967295,
+                                    4294967296, -1, -24, -25, -32, -33, -128, -129, -256, -257,
+                                    -32768, -32769, -65537,
+                                    std::numeric_limits<std::int64_t>::min()});
+    check(std::vector<std::uint64_t>{std::numeric_limits<std::uint64_t>::max()});
+    check(std::vector<double>{0.5, 0.1, -2.0, 1e300, std::numeric_limits<double>::infinity(),
+                              -std::numeric_limits<double>::infinity()});
+    // `float`s are encoded in single precision, whereas the double in the DOM is only encoded
+    // in single precision if it is exact
+    check(std::vector<float>{0.5F, -2.0F, 16777216.0F, std::numeric_limits<float>::infinity(),
+                             -std::numeric_limits<float>::infinity()});
+    const std::vector<float> inexact{0.1F, -1e-45F, 3.4028235e38F, 123456.79F};
+    THES_ASSERT(jay::parse_cbor<std::vector<float>>(jay::to_cbor(inexact)) == inexact);
+    THES_ASSERT(jay::parse_msgpack<std::vector<float>>(jay::to_msgpack(inexact)) == inexact);
+    THES_ASSERT(jay::to_cbor(0.1F).size() == 5 && jay::to_msgpack(0.1F).size() == 5);
+    THES_ASSERT(Json::to_cbor(jay::to_json(0.1F)).size() == 9 &&
+                Json::to_msgpack(jay::to_json(0.1F)).size() == 9);
+    std::map<std::string, std::vector<std::string>> strings{};
+    for (const std::size_t size : {0U, 15U, 16U, 23U, 24U, 31U, 32U, 255U, 256U, 65535U, 70000U}) {
+      strings[std::string(size, 'k')] = {std::string(size, 'v'), ""};
+    }
+    check(strings);
+    // 16-bit and 32-bit lengths of arrays and maps
+    std::map<std::string, std::vector<int>> wide{};
+    for (int i = 0; i < 20; ++i) {
+      wide[fmt::format("k{}", i)] = std::vector<int>(static_cast<std::size_t>(i) * 4000, i);
+    }
+    check(wide);
+
+    // Indefinite lengths and half-precision floats, which are not produced by the writer
+    const std::vector<std::uint8_t> indefinite{0xBF, 0x61, 'a', 0x9F, 0xF9, 0x3C, 0x00, 0x7F,
+                                               0x61, 'x', 0x61, 'y', 0xFF, 0xFF, 0xFF};
+    const auto indefinite_json = Json::parse(R"({"a":[1.0,"xy"]})");
+    THES_ASSERT(jay::parse_cbor<Json>(indefinite) == indefinite_json);
+    const auto indefinite_map = jay::parse_cbor<std::map<std::string, Json>>(indefinite);
+    THES_ASSERT(indefinite_map.at("a") == indefinite_json.at("a"));
+
+    // Errors are the same as for the DOM-based path
+    const Json bad = Json::parse(R"({"a":"x","b":[2.0,3],"c":1})");
+    auto message = [](auto op) {
+      try {
+        op();
+      } catch (const std::exception& ex) {
+        return std::string{ex.what()};
+      }
+      return std::string{};
+    };
+    const std::string expected = message([&] { jay::from_json<Test1>(bad); });
+    THES_ASSERT(!expected.empty());
+    THES_ASSERT(message([&] { jay::parse_cbor<Test1>(Json::to_cbor(bad)); }) == expected);
+    THES_ASSERT(message([&] { jay::parse_msgpack<Test1>(Json::to_msgpack(bad)); }) == expected);
+  }
+
+  // DOMs allocated from an arena
+  {
+    std::pmr::monotonic_buffer_resource resource{};
+    std::optional<jay::ArenaJson> outlived{};
+    {
+      const jay::ArenaScope scope{resource};
+      const Test3 test{1.5, TestTwo{2.0, Test1{0.5, {0.1F, -7}, 2}, 3}};
+      const auto arena_json = jay::to_basic_json<jay::ArenaJson>(test);
+      THES_ASSERT(std::string_view{arena_json.dump()} == jay::to_json(test).dump());
+      THES_ASSERT(jay::to_json_string(arena_json, 2) == jay::to_json(test).dump(2));
+      THES_ASSERT(jay::to_json(jay::from_json<Test3>(arena_json)) == jay::to_json(test));
+
+      const auto parsed = jay::ArenaJson::parse(R"({"x": [1, 2.5, "s"], "y": {"z": null}})");
+      using Map = std::map<std::string, Json>;
+      const auto map = jay::from_json<Map>(parsed);
+      THES_ASSERT(map.at("x") == Json::parse(R"([1, 2.5, "s"])") && map.at("y").size() == 1);
+      outlived = parsed;
+    }
+    // Values can be modified and freed after the scope of their arena has ended
+    outlived->at("x").push_back(true);
+    outlived.reset();
+
+    const jay::ArenaJson bad = jay::ArenaJson::parse(R"({"a":"x","b":[2.0,3],"c":1})");
+    auto message = [](auto op) {
+      try {
+        op();
+      } catch (const std::exception& ex) {
+        return std::string{ex.what()};
+      }
+      return std::string{};
+    };
+    const std::string expected = message([&] { jay::from_json<Test1>(Json(bad)); });
+    THES_ASSERT(!expected.empty() && message([&] { jay::from_json<Test1>(bad); }) == expected);
+  }
+  {
+    // Strings are allocated from the arena as well
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource bounded{buffer.data(), buffer.size(),
+                                                std::pmr::null_memory_resource()};
+    const jay::ArenaScope scope{bounded};
+    const auto json = jay::ArenaJson::parse(R"({"key": "a string which is too long for SSO"})");
+    const auto* data = reinterpret_cast<const std::byte*>(
+      json.at("key").get_ref<const jay::ArenaString&>().data());
+    THES_ASSERT(buffer.data() <= data && data < buffer.data() + buffer.size());
+    THES_ASSERT(jay::from_json<Labels>(jay::ArenaJson::parse(
+                  R"({"id": "an identifier which is too long for SSO", "paths": ["/"]})"))
+                  .id == "an identifier which is too long for SSO");
+  }
+  {
+    // DOMs kept in an arena are released without being destroyed
+    jay::Arena arena{};
+    const jay::ArenaJson& doc =
+      arena.keep(jay::ArenaJson::parse(R"({"x": [1, 2.5, "a string which is too long for SSO"]})"));
+    THES_ASSERT(doc.at("x").at(2) == "a string which is too long for SSO");
+    THES_ASSERT(jay::to_json_string(doc) == std::string_view{doc.dump()});
+  }
+
+  // Decoding an rvalue DOM moves its strings instead of copying them
+  {
+    const std::string long_id(64, 'i');
+    const std::string long_path(64, 'p');
+    auto make_json = [&] {
+      return Json{{"id", long_id}, {"paths", {long_path, "/"}}, {"note", long_path + long_id}};
+    };
+    auto data_of = [](const Json& json) { return json.get_ref<const std::string&>().data(); };
+
+    Json json = make_json();
+    const char* id_data = data_of(json["id"]);
+    const char* path_data = data_of(json["paths"][0]);
+    const char* note_data = data_of(json["note"]);
+    const auto labels = jay::from_json<Labels>(std::move(json));
+    THES_ASSERT(labels.id == long_id && labels.paths.size() == 2 && labels.paths[1] == "/");
+    THES_ASSERT(labels.id.data() == id_data && labels.paths[0].data() == path_data &&
+                labels.note->data() == note_data);
+
+    Json nested{{"labels", make_json()}};
+    const char* nested_data = data_of(nested["labels"]["id"]);
+    using Var = std::variant<Labels, Test1>;
+    const auto var = jay::from_json<std::optional<Var>>(std::move(nested));
+    THES_ASSERT(std::get<Labels>(*var).id.data() == nested_data);
+
+    Json map_json{{"a", make_json()}, {"b", nullptr}};
+    const char* map_data = data_of(map_json["a"]["paths"][0]);
+    auto map = jay::json_fetch<std::map<std::string, std::optional<Labels>>>(
+      Json{{"map", std::move(map_json)}}, "map");
+    THES_ASSERT(map.at("a")->paths[0].data() == map_data && !map.at("b").has_value());
+
+    // The results and errors are the same as when decoding from an lvalue
+    const Json reference = make_json();
+    THES_ASSERT(jay::to_json(jay::from_json<Labels>(Json(reference))) == reference);
+    const Json bad = Json::parse(R"({"a":"x","b":[2.0,3],"c":1})");
+    auto message = [](auto op) {
+      try {
+        op();
+      } catch (const std::exception& ex) {
+        return std::string{ex.what()};
+      }
+      return std::string{};
+    };
+    for (const Json& input : {bad, Json::parse("[1]"), Json::parse(R"({"test_two": 1})")}) {
+      const std::string expected = message([&] { jay::from_json<Var>(input); });
+      THES_ASSERT(!expected.empty());
+      THES_ASSERT(message([&] { jay::from_json<Var>(Json(input)); }) == expected);
+    }
+  }
+
+  {
+    // Typed JSON Patches
+    const Test3 source{1.0F, TestTwo{2.0F, Test1{0.5F, {2.0F, 3}, 4}, 5}};
+    const Test3 target{1.0F, TestTwo{2.0F, Test1{0.5F, {2.5F, 3}, 6}, 5}};
+    const Json patch = jay::diff(source, target);
+    THES_ASSERT(patch == Json::diff(jay::to_json(source), jay::to_json(target)));
+    THES_ASSERT(patch.size() == 2 && jay::diff(source, source).empty());
+    Test3 patched = source;
+    jay::apply_patch(patched, patch);
+    THES_ASSERT(jay::to_json(patched) == jay::to_json(target));
+
+    const Test3 other{3.0F, Test1{0.5F, {2.0F, 3}, 4}};
+    THES_ASSERT(jay::diff(source, other) ==
+                Json::diff(jay::to_json(source), jay::to_json(other)));
+    const Test5 five{5};
+    const Test5 six{6};
+    THES_ASSERT(jay::diff(five, six) == Json::diff(jay::to_json(five), jay::to_json(six)));
+
+    // The results and errors are the same as when patching the DOM
+    auto outcome = [](auto op) {
+      try {
+        return op().dump();
+      } catch (const std::exception& ex) {
+        return std::string{ex.what()};
+      }
+    };
+    auto check = [&]<typename T>(const T& value, const Json& ops) {
+      const std::string expected = outcome([&] {
+        return jay::to_json(jay::from_json<T>(jay::to_json(value).patch(ops)));
+      });
+      const std::string actual = outcome([&] {
+        T copy = value;
+        jay::apply_patch(copy, ops);
+        return jay::to_json(copy);
+      });
+      THES_ASSERT(actual == expected);
+    };
+    for (const char* ops : {
+           R"([{"op":"replace","path":"/a","value":7}])",
+           R"([{"op":"add","path":"/b","value":{"Test1":{"a":1,"b":[2,3],"c":4}}}])",
+           R"([{"op":"replace","path":"/b/test_two/b/b/0","value":9}])",
+           R"([{"op":"replace","path":"/b/test_two/b/b/5","value":9}])",
+           R"([{"op":"remove","path":"/b/test_two/b/b/1"}])",
+           R"([{"op":"remove","path":"/a"}])",
+           R"([{"op":"replace","path":"/b/test_two","value":{"a":1,"b":{"a":0,"b":[2,3],"c":1}}}])",
+           R"([{"op":"add","path":"/b/Test1","value":{"a":1,"b":[2,3],"c":4}}])",
+           R"([{"op":"remove","path":"/b/test_two"}])",
+           R"([{"op":"remove","path":"/b/test_two/c"}])",
+           R"([{"op":"replace","path":"/a","value":"x"}])",
+           R"([{"op":"replace","path":"/a"}])",
+           R"([{"op":"test","path":"/b/test_two/c","value":5},)"
+           R"({"op":"replace","path":"/a","value":2}])",
+           R"([{"op":"test","path":"/b/test_two/c","value":6}])",
+           R"([{"op":"add","path":"/extra","value":1}])",
+           R"([{"op":"copy","from":"/b/test_two/a","path":"/a"}])",
+           R"([{"op":"move","from":"/a","path":"/c"}])",
+           R"([{"op":"invalid","path":"/a"}])",
+           R"([{"op":"replace","path":"a","value":7}])",
+           R"([{"op":"replace","path":"/b/test_two/~2","value":7}])",
+           R"([{"op":"replace","path":"","value":{"a":2,"b":{"Test1":{"a":1,"b":[2,3],"c":4}}}}])",
+           R"([1])",
+           R"({})",
+         }) {
+      check(source, Json::parse(ops));
+    }
+    for (const char* ops : {
+           R"([{"op":"replace","path":"/a","value":7}])",
+           R"([{"op":"replace","path":"/value","value":"backward"}])",
+           R"([{"op":"replace","path":"/type","value":"f32"}])",
+           R"([{"op":"test","path":"/type","value":"f32"}])",
+         }) {
+      check(five, Json::parse(ops));
+    }
+  }
+
+  // Interned strings share the storage of equal strings
+  {
+    const std::string text =
+      R"([{"label": ["red", "green"]}, {"label": ["red"], "other": ["green", "red"]}])";
+    using Record = std::map<jay::InternedString, std::vector<jay::InternedString>>;
+    using HashRecord = ankerl::unordered_dense::map<jay::InternedString, jay::InternedString>;
+    jay::InternPool pool{};
+    std::vector<Record> parsed{};
+    std::vector<Record> decoded{};
+    HashRecord hashed{};
+    {
+      const jay::InternScope scope{pool};
+      parsed = jay::parse<std::vector<Record>>(text);
+      decoded = jay::from_json<std::vector<Record>>(Json::parse(text));
+      hashed = jay::parse<HashRecord>(R"({"b": "red", "a": "blue"})");
+      THES_ASSERT(!jay::try_from_json<std::vector<jay::InternedString>>(Json::parse("[1]")));
+    }
+    THES_ASSERT(parsed == decoded);
+    THES_ASSERT(pool.size() == 7 && pool.bytes() == 24);
+    const jay::InternedString label{"label"};
+    THES_ASSERT(parsed[0].at(label)[0].view().data() == parsed[1].at(label)[0].view().data());
+    THES_ASSERT(parsed[0].begin()->first.view().data() == decoded[1].begin()->first.view().data());
+    THES_ASSERT(thes::test::string_eq(Json::parse(text).dump(), jay::to_json_string(parsed)));
+    THES_ASSERT(jay::to_json(decoded) == Json::parse(text));
+    THES_ASSERT(
+      thes::test::string_eq(R"({"a":"blue","b":"red"})", jay::to_json_string(hashed)));
+
+    // Decoding requires a pool
+    try {
+      jay::parse<jay::InternedString>(R"("x")");
+      return 1;
+    } catch (const std::logic_error& /*ex*/) {
+    }
+  }
 }